@@ -1,613 +1,2346 @@
-/* Bus_Reservation_System.c
-   Combined Basic + Advanced features
-   Portable C (uses only stdio.h, stdlib.h, string.h, time.h, ctype.h)
-   Compile: gcc Bus_Reservation_System.c -o bus.exe
-*/
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
-#include <ctype.h>
-#include <stdarg.h>
-
-
-#define MAX_BUSES 5
-#define MAX_SEATS 32
-#define MAX_NAME_LEN 100
-#define USER_FILE "users.txt"
-#define CURRENT_USER_LEN 64
-
-/* Bus names (you can change) */
-const char *bus_names[MAX_BUSES] = {
-    "Manglore Express",
-    "Karwar Express",
-    "Airavat Express",
-    "SeaBird Express",
-    "Newport Express"
-};
-
-/* Globals */
-char current_user[CURRENT_USER_LEN] = {0}; /* holds username after successful login */
-
-/* Function prototypes */
-void initialize_files_if_missing();
-void main_menu();
-void view_bus_list();
-void book_tickets();
-void cancel_booking();
-void show_bus_status();
-void show_bus_status_quiet(int bus_no); /* internal use */
-int read_available_seats(int bus_no);
-void write_available_seats(int bus_no, int seats);
-void read_status_into_array(int bus_no, char status[][MAX_NAME_LEN], int *count);
-void write_status_from_array(int bus_no, char status[][MAX_NAME_LEN], int count);
-void register_user();
-int login_user();
-void pause_console();
-int sanitize_username(const char *in, char *out, size_t outlen);
-void append_user_log(const char *fmt, ...);
-void get_timestamp(char *buf, size_t len);
-
-int main(void) {
-    initialize_files_if_missing();
-    main_menu();
-    return 0;
-}
-
-/* Ensure data files exist for each bus and user file exists */
-void initialize_files_if_missing() {
-    int i;
-    for (i = 1; i <= MAX_BUSES; ++i) {
-        char seats_fname[64], status_fname[64];
-        snprintf(seats_fname, sizeof(seats_fname), "bus%d_seats.txt", i);
-        snprintf(status_fname, sizeof(status_fname), "bus%d_status.txt", i);
-
-        FILE *fs = fopen(seats_fname, "r");
-        if (!fs) {
-            fs = fopen(seats_fname, "w");
-            if (fs) {
-                fprintf(fs, "%d\n", MAX_SEATS); /* initially all seats available */
-                fclose(fs);
-            }
-        } else {
-            fclose(fs);
-        }
-
-        FILE *fst = fopen(status_fname, "r");
-        if (!fst) {
-            fst = fopen(status_fname, "w");
-            if (fst) {
-                /* write MAX_SEATS "Empty" entries separated by newlines */
-                for (int s = 0; s < MAX_SEATS; ++s) {
-                    fprintf(fst, "Empty\n");
-                }
-                fclose(fst);
-            }
-        } else {
-            fclose(fst);
-        }
-    }
-
-    /* Ensure user file exists */
-    FILE *fu = fopen(USER_FILE, "r");
-    if (!fu) {
-        fu = fopen(USER_FILE, "w");
-        if (fu) {
-            /* create a default admin account for convenience */
-            fprintf(fu, "admin adminpass\n"); /* username admin, password adminpass */
-            fclose(fu);
-        }
-    } else {
-        fclose(fu);
-    }
-}
-
-/* Pause helper */
-void pause_console() {
-    printf("\nPress Enter to continue...");
-    int c;
-    /* consume leftover input until newline */
-    while ((c = getchar()) != '\n' && c != EOF) {}
-}
-
-/* Main menu with login/registration flow */
-void main_menu() {
-    int logged_in = 0;
-    char choice[8];
-
-    while (1) {
-        #ifdef _WIN32
-            system("cls");
-        #else
-            system("clear");
-        #endif
-
-        printf("====================================== WELCOME TO BUS RESERVATION SYSTEM ======================================\n\n");
-        printf("Please choose an option:\n");
-        printf(" 1) Login\n");
-        printf(" 2) Register (create new user)\n");
-        printf(" 3) View Bus List (no login required)\n");
-        printf(" 4) Exit\n");
-        printf("\nEnter choice: ");
-        if (!fgets(choice, sizeof(choice), stdin)) return;
-        int opt = atoi(choice);
-
-        if (opt == 1) {
-            logged_in = login_user();
-            if (logged_in) {
-                /* After login, show user menu */
-                int user_opt = 0;
-                while (1) {
-                    #ifdef _WIN32
-                        system("cls");
-                    #else
-                        system("clear");
-                    #endif
-
-                    printf("Logged in as: %s\n", current_user);
-                    printf("Choose action:\n");
-                    printf(" 1) View Bus List\n");
-                    printf(" 2) Book Tickets\n");
-                    printf(" 3) Cancel Booking\n");
-                    printf(" 4) View Bus Status\n");
-                    printf(" 5) Logout\n");
-                    printf("Enter choice: ");
-                    if (!fgets(choice, sizeof(choice), stdin)) return;
-                    user_opt = atoi(choice);
-                    if (user_opt == 1) view_bus_list();
-                    else if (user_opt == 2) book_tickets();
-                    else if (user_opt == 3) cancel_booking();
-                    else if (user_opt == 4) show_bus_status();
-                    else if (user_opt == 5) {
-                        /* append logout entry to user file and clear current_user */
-                        if (current_user[0] != '\0') {
-                            append_user_log("Logged out");
-                            current_user[0] = '\0';
-                        }
-                        break;
-                    }
-                    else printf("Invalid choice.\n");
-                    pause_console();
-                }
-            } else {
-                printf("Login failed.\n");
-                pause_console();
-            }
-        } else if (opt == 2) {
-            register_user();
-            pause_console();
-        } else if (opt == 3) {
-            view_bus_list();
-            pause_console();
-        } else if (opt == 4) {
-            printf("Thank you for using the system!\n");
-            break;
-        } else {
-            printf("Invalid option. Try again.\n");
-            pause_console();
-        }
-    }
-}
-
-/* Show the list of buses and available seats */
-void view_bus_list() {
-    #ifdef _WIN32
-        system("cls");
-    #else
-        system("clear");
-    #endif
-
-    printf("=========================================== BUS LIST ============================================\n\n");
-    for (int i = 0; i < MAX_BUSES; ++i) {
-        int avail = read_available_seats(i+1);
-        printf(" [%d] %s   - Available seats: %d\n", i+1, bus_names[i], avail);
-    }
-}
-
-/* Booking flow */
-void book_tickets() {
-    char input[16];
-    view_bus_list();
-    printf("\nEnter bus number to book: ");
-    if (!fgets(input, sizeof(input), stdin)) return;
-    int bus_no = atoi(input);
-    if (bus_no < 1 || bus_no > MAX_BUSES) {
-        printf("Invalid bus number.\n");
-        return;
-    }
-
-    int avail = read_available_seats(bus_no);
-    if (avail <= 0) {
-        printf("No seats available on this bus.\n");
-        return;
-    }
-
-    printf("You selected: %s (Available seats: %d)\n", bus_names[bus_no-1], avail);
-    printf("How many tickets do you want to book (1-%d)? ", avail);
-    if (!fgets(input, sizeof(input), stdin)) return;
-    int num = atoi(input);
-    if (num < 1 || num > avail) {
-        printf("Invalid ticket count.\n");
-        return;
-    }
-
-    /* load current status into array */
-    char status[MAX_SEATS][MAX_NAME_LEN];
-    int count = 0;
-    read_status_into_array(bus_no, status, &count);
-
-    for (int t = 0; t < num; ++t) {
-        int seat_choice = 0;
-        printf("\nEnter seat number to book (1-%d): ", MAX_SEATS);
-        if (!fgets(input, sizeof(input), stdin)) return;
-        seat_choice = atoi(input);
-        if (seat_choice < 1 || seat_choice > MAX_SEATS) {
-            printf("Invalid seat number. Try again.\n");
-            t--; /* retry this ticket */
-            continue;
-        }
-        /* check if seat is empty */
-        if (strncmp(status[seat_choice-1], "Empty", 5) != 0) {
-            printf("Seat %d is already booked by %s. Choose a different seat.\n", seat_choice, status[seat_choice-1]);
-            t--;
-            continue;
-        }
-        printf("Enter passenger name for seat %d: ", seat_choice);
-        char name_in[MAX_NAME_LEN];
-        if (!fgets(name_in, sizeof(name_in), stdin)) return;
-        /* trim newline */
-        name_in[strcspn(name_in, "\n")] = '\0';
-        if (strlen(name_in) == 0) {
-            printf("Name cannot be empty. Try again.\n");
-            t--;
-            continue;
-        }
-        strncpy(status[seat_choice-1], name_in, MAX_NAME_LEN-1);
-        status[seat_choice-1][MAX_NAME_LEN-1] = '\0';
-
-        printf("Seat %d booked for %s.\n", seat_choice, status[seat_choice-1]);
-
-        /* append booking to current user's file (if logged in) */
-        if (current_user[0] != '\0') {
-            char msg[256];
-            snprintf(msg, sizeof(msg), "Booked: Bus %d Seat %d Name: %s", bus_no, seat_choice, status[seat_choice-1]);
-            append_user_log("%s", msg);
-        }
-    }
-
-    /* update seats count and status file */
-    int new_avail = read_available_seats(bus_no) - num;
-    write_available_seats(bus_no, new_avail);
-    write_status_from_array(bus_no, status, MAX_SEATS);
-
-    printf("\nBooking complete. Total charge: Rs %d\n", 200 * num);
-}
-
-/* Cancel booking */
-void cancel_booking() {
-    char input[16];
-    view_bus_list();
-    printf("\nEnter bus number for cancellation: ");
-    if (!fgets(input, sizeof(input), stdin)) return;
-    int bus_no = atoi(input);
-    if (bus_no < 1 || bus_no > MAX_BUSES) {
-        printf("Invalid bus number.\n");
-        return;
-    }
-
-    show_bus_status_quiet(bus_no); /* shows seat map */
-
-    printf("\nEnter seat number to cancel: ");
-    if (!fgets(input, sizeof(input), stdin)) return;
-    int seat_no = atoi(input);
-    if (seat_no < 1 || seat_no > MAX_SEATS) {
-        printf("Invalid seat number.\n");
-        return;
-    }
-
-    char status[MAX_SEATS][MAX_NAME_LEN];
-    int count = 0;
-    read_status_into_array(bus_no, status, &count);
-
-    if (strncmp(status[seat_no-1], "Empty", 5) == 0) {
-        printf("Seat %d is already empty.\n", seat_no);
-        return;
-    }
-
-    printf("Cancelling seat %d booked by %s\n", seat_no, status[seat_no-1]);
-    strncpy(status[seat_no-1], "Empty", MAX_NAME_LEN-1);
-    status[seat_no-1][MAX_NAME_LEN-1] = '\0';
-
-    write_status_from_array(bus_no, status, MAX_SEATS);
-    int new_avail = read_available_seats(bus_no) + 1;
-    write_available_seats(bus_no, new_avail);
-
-    /* append cancellation to current user's file (if logged in) */
-    if (current_user[0] != '\0') {
-        char msg[256];
-        snprintf(msg, sizeof(msg), "Cancelled: Bus %d Seat %d", bus_no, seat_no);
-        append_user_log("%s", msg);
-    }
-
-    printf("Cancellation successful. Rs 200 will be refunded (simulated).\n");
-}
-
-/* Show seat status in a nice grid */
-void show_bus_status() {
-    char input[16];
-    view_bus_list();
-    printf("\nEnter bus number to view status: ");
-    if (!fgets(input, sizeof(input), stdin)) return;
-    int bus_no = atoi(input);
-    if (bus_no < 1 || bus_no > MAX_BUSES) {
-        printf("Invalid bus number.\n");
-        return;
-    }
-    show_bus_status_quiet(bus_no);
-}
-
-/* Internal function to print status */
-void show_bus_status_quiet(int bus_no) {
-    char status[MAX_SEATS][MAX_NAME_LEN];
-    int count = 0;
-    read_status_into_array(bus_no, status, &count);
-
-    printf("\nBus %d --> %s\n", bus_no, bus_names[bus_no-1]);
-    printf("--------------------------------------------------------------------------------\n");
-    int index = 0;
-    for (int row = 0; row < 8; ++row) {
-        printf("\t");
-        for (int col = 0; col < 4; ++col) {
-            int seat = index + 1;
-            printf("%2d.", seat);
-            if (strncmp(status[index], "Empty", 5) == 0)
-                printf("Empty\t\t");
-            else {
-                /* print up to 10 chars of name for compact view */
-                char shortname[12];
-                strncpy(shortname, status[index], 10);
-                shortname[10] = '\0';
-                printf("%s\t", shortname);
-            }
-            index++;
-        }
-        printf("\n");
-    }
-}
-
-/* Read available seats from file */
-int read_available_seats(int bus_no) {
-    char fname[64];
-    snprintf(fname, sizeof(fname), "bus%d_seats.txt", bus_no);
-    FILE *f = fopen(fname, "r");
-    if (!f) return 0;
-    int x = 0;
-    if (fscanf(f, "%d", &x) != 1) x = 0;
-    fclose(f);
-    return x;
-}
-
-/* Write available seats to file */
-void write_available_seats(int bus_no, int seats) {
-    char fname[64];
-    snprintf(fname, sizeof(fname), "bus%d_seats.txt", bus_no);
-    FILE *f = fopen(fname, "w");
-    if (!f) {
-        printf("Error writing seats file for bus %d\n", bus_no);
-        return;
-    }
-    fprintf(f, "%d\n", seats);
-    fclose(f);
-}
-
-/* Read status file lines into provided array.
-   status[i] will contain the string for seat i (0-based).
-   count is filled with number of lines read (should be MAX_SEATS). */
-void read_status_into_array(int bus_no, char status[][MAX_NAME_LEN], int *count) {
-    char fname[64];
-    snprintf(fname, sizeof(fname), "bus%d_status.txt", bus_no);
-    FILE *f = fopen(fname, "r");
-    if (!f) {
-        /* create default */
-        for (int i = 0; i < MAX_SEATS; ++i) {
-            strncpy(status[i], "Empty", MAX_NAME_LEN-1);
-            status[i][MAX_NAME_LEN-1] = '\0';
-        }
-        *count = MAX_SEATS;
-        return;
-    }
-    char line[256];
-    int idx = 0;
-    while (fgets(line, sizeof(line), f) && idx < MAX_SEATS) {
-        /* strip newline */
-        line[strcspn(line, "\n")] = '\0';
-        if (strlen(line) == 0) strncpy(status[idx], "Empty", MAX_NAME_LEN-1);
-        else strncpy(status[idx], line, MAX_NAME_LEN-1);
-        status[idx][MAX_NAME_LEN-1] = '\0';
-        idx++;
-    }
-    /* if file had fewer lines, fill rest with Empty */
-    while (idx < MAX_SEATS) {
-        strncpy(status[idx], "Empty", MAX_NAME_LEN-1);
-        status[idx][MAX_NAME_LEN-1] = '\0';
-        idx++;
-    }
-    fclose(f);
-    *count = idx;
-}
-
-/* Write status array back to file */
-void write_status_from_array(int bus_no, char status[][MAX_NAME_LEN], int count) {
-    char fname[64];
-    snprintf(fname, sizeof(fname), "bus%d_status.txt", bus_no);
-    FILE *f = fopen(fname, "w");
-    if (!f) {
-        printf("Error writing status file for bus %d\n", bus_no);
-        return;
-    }
-    for (int i = 0; i < count; ++i) {
-        fprintf(f, "%s\n", status[i]);
-    }
-    fclose(f);
-}
-
-/* Helper: get timestamp string */
-void get_timestamp(char *buf, size_t len) {
-    time_t t = time(NULL);
-    struct tm *tm_info = localtime(&t);
-    strftime(buf, len, "%Y-%m-%d %H:%M:%S", tm_info);
-}
-
-/* Append a log message into current user's file with timestamp */
-void append_user_log(const char *fmt, ...) {
-    if (current_user[0] == '\0') return; /* no logged-in user */
-    char user_fname[128];
-    snprintf(user_fname, sizeof(user_fname), "%s.txt", current_user);
-
-    FILE *uf = fopen(user_fname, "a");
-    if (!uf) return;
-
-    /* timestamp */
-    char ts[64];
-    get_timestamp(ts, sizeof(ts));
-    fprintf(uf, "%s - ", ts);
-
-    /* formatted message */
-    va_list args;
-    va_start(args, fmt);
-    vfprintf(uf, fmt, args);
-    va_end(args);
-
-    fprintf(uf, "\n");
-    fclose(uf);
-}
-
-/* Sanitizes username: keep letters, digits, underscore, hyphen only.
-   returns 1 if good, 0 if invalid (empty after sanitize). */
-int sanitize_username(const char *in, char *out, size_t outlen) {
-    if (!in || !out || outlen == 0) return 0;
-    size_t j = 0;
-    for (size_t i = 0; in[i] != '\0' && j + 1 < outlen; ++i) {
-        char c = in[i];
-        if (isalnum((unsigned char)c) || c == '_' || c == '-') {
-            out[j++] = c;
-        } else {
-            /* skip other characters (space, slash, etc.) */
-        }
-    }
-    if (j == 0) {
-        out[0] = '\0';
-        return 0;
-    }
-    out[j] = '\0';
-    return 1;
-}
-
-/* Registration: creates an entry in users.txt and creates username.txt user file */
-void register_user() {
-    char username_raw[64], password[64], username[64];
-    printf("\n===== Register New User =====\n");
-    printf("Enter username (letters, digits, _ or - only): ");
-    if (!fgets(username_raw, sizeof(username_raw), stdin)) return;
-    username_raw[strcspn(username_raw, "\n")] = '\0';
-
-    if (!sanitize_username(username_raw, username, sizeof(username))) {
-        printf("Invalid username. Use letters/digits/_/- and avoid spaces.\n");
-        return;
-    }
-
-    printf("Enter password: ");
-    if (!fgets(password, sizeof(password), stdin)) return;
-    password[strcspn(password, "\n")] = '\0';
-
-    if (strlen(password) == 0) {
-        printf("Password cannot be empty.\n");
-        return;
-    }
-
-    /* check if user exists in users file */
-    FILE *f = fopen(USER_FILE, "r");
-    char u[64], p[64];
-    while (f && (fscanf(f, "%63s %63s", u, p) == 2)) {
-        if (strcmp(u, username) == 0) {
-            printf("Username already exists. Choose a different username.\n");
-            if (f) fclose(f);
-            return;
-        }
-    }
-    if (f) fclose(f);
-
-    /* append to users.txt */
-    f = fopen(USER_FILE, "a");
-    if (!f) {
-        printf("Error opening user database file.\n");
-        return;
-    }
-    fprintf(f, "%s %s\n", username, password);
-    fclose(f);
-
-    /* create user's personal file and write header + registration log */
-    char user_fname[128];
-    snprintf(user_fname, sizeof(user_fname), "%s.txt", username);
-    FILE *uf = fopen(user_fname, "a");
-    if (!uf) {
-        printf("Error creating user file %s\n", user_fname);
-        return;
-    }
-    fprintf(uf, "== User: %s ==\n", username);
-    fprintf(uf, "Activity Log:\n");
-    fclose(uf);
-
-    /* temporarily set current_user to write registration log */
-    strncpy(current_user, username, sizeof(current_user)-1);
-    current_user[sizeof(current_user)-1] = '\0';
-    append_user_log("Registered");
-    /* do not clear current_user here - user still not logged in; keep it blank for safety */
-    current_user[0] = '\0';
-
-    printf("Registration successful. You can now login.\n");
-}
-
-/* Login: check users.txt for username & password; on success set current_user and log it */
-int login_user() {
-    char username_raw[64], password[64], username[64];
-    printf("\n===== Login =====\n");
-    printf("Username: ");
-    if (!fgets(username_raw, sizeof(username_raw), stdin)) return 0;
-    username_raw[strcspn(username_raw, "\n")] = '\0';
-
-    if (!sanitize_username(username_raw, username, sizeof(username))) {
-        printf("Invalid username format.\n");
-        return 0;
-    }
-
-    printf("Password: ");
-    if (!fgets(password, sizeof(password), stdin)) return 0;
-    password[strcspn(password, "\n")] = '\0';
-
-    FILE *f = fopen(USER_FILE, "r");
-    if (!f) {
-        printf("User database missing.\n");
-        return 0;
-    }
-    char u[64], p[64];
-    int ok = 0;
-    while (fscanf(f, "%63s %63s", u, p) == 2) {
-        if (strcmp(u, username) == 0 && strcmp(p, password) == 0) {
-            ok = 1;
-            break;
-        }
-    }
-    fclose(f);
-    if (ok) {
-        strncpy(current_user, username, sizeof(current_user)-1);
-        current_user[sizeof(current_user)-1] = '\0';
-        append_user_log("Logged in");
-        printf("Login successful. Welcome, %s!\n", username);
-        return 1;
-    } else {
-        printf("Invalid credentials.\n");
-        return 0;
-    }
-}
+/* Bus_Reservation_System.c
+   Combined Basic + Advanced features
+   Portable C (uses only stdio.h, stdlib.h, string.h, time.h, ctype.h, sys/stat.h,
+   plus unistd.h/dirent.h or direct.h/io.h/process.h for --data-dir and
+   the per-process temp files and forcing them to disk)
+   Compile: gcc Bus_Reservation_System.c -o bus.exe
+   Data:    bus.exe --data-dir <dir> [other options]  (default: current directory)
+   Fleet:   buses.txt, one bus per line: <seats> <seats per row> <name>
+   Batch:   bus.exe --batch bookings.txt [results.txt]
+   Bench:   bus.exe --bench [iterations] [extra_users]
+   History: bus.exe --import-history [extra usernames...]
+   Check:   bus.exe --check   (report problems in the data files)
+            bus.exe --repair  (report and fix them)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+    #include <direct.h>
+    #include <io.h>
+    #include <process.h>
+    #define change_dir _chdir
+    #define get_pid _getpid
+    #define sync_file(f) _commit(_fileno(f))
+    #include <windows.h>
+    #define sleep_ms(ms) Sleep(ms)
+#else
+    #include <unistd.h>
+    #include <dirent.h>
+    #define change_dir chdir
+    #define get_pid getpid
+    #define sync_file(f) fsync(fileno(f))
+    #define sleep_ms(ms) usleep((ms) * 1000)
+#endif
+
+
+#define MAX_NAME_LEN 100
+#define BUS_NAME_LEN 64
+#define FLEET_FILE "buses.txt"
+#define DEFAULT_BUSES 5
+#define DEFAULT_SEATS 32
+#define DEFAULT_SEATS_PER_ROW 4
+#define PREFER_ANY 0
+#define PREFER_WINDOW 1
+#define PREFER_AISLE 2
+#define USER_FILE "users.txt"
+#define HISTORY_FILE "bookings.txt"
+#define CURRENT_USER_LEN 64
+#define PASSWORD_LEN 64
+#define USER_TABLE_MIN_SIZE 64 /* must be a power of two */
+#define LOCK_WAIT_MS 5000  /* give up on a bus lock held longer than this */
+#define LOCK_STALE_SECS 30 /* a lock file this old was left by a crashed copy */
+#define BATCH_GROUP_MAX 4096 /* batch lines applied with one status file write */
+
+/* Default fleet written to buses.txt on first run (edit buses.txt to change) */
+const char *default_bus_names[DEFAULT_BUSES] = {
+    "Manglore Express",
+    "Karwar Express",
+    "Airavat Express",
+    "SeaBird Express",
+    "Newport Express"
+};
+
+/* Globals */
+/* State of one logged-in user, passed explicitly to everything that acts
+   on the user's behalf (booking, cancelling, logging) */
+struct session {
+    char user[CURRENT_USER_LEN]; /* username after successful login, "" if none */
+    FILE *log;                   /* user's activity log, kept open between entries */
+};
+
+/* Fleet loaded from buses.txt; bus N is fleet[N-1] */
+struct bus_info {
+    char name[BUS_NAME_LEN];
+    int seats;         /* number of seats */
+    int seats_per_row; /* columns in the seat map */
+    int first_seat;    /* index of this bus's seat 1 in seat_status */
+    time_t file_mtime; /* status file modification time and size when last */
+    long file_size;    /* read or written, to spot changes by other copies */
+    time_t file_seen;  /* clock time when file_mtime/file_size were taken */
+};
+struct bus_info *fleet = NULL;
+int bus_count = 0;
+
+/* In-memory copy of every busN_status.txt, loaded once at startup.
+   All buses share one contiguous array, bus after bus (see bus_seats()).
+   Each seat holds a heap-allocated passenger name, or NULL when empty
+   ("Empty" only exists in the text files). seat_owner holds, at the same
+   index, the account that booked the seat (NULL if unknown); in the file
+   it follows the name after a tab. Change seats only through set_seat().
+   All reads are served from here; each change rewrites only that bus's file. */
+char **seat_status = NULL;
+char **seat_owner = NULL;
+int total_seats = 0;
+
+/* A booked seat, as listed in a user's booking index */
+struct seat_ref {
+    int bus_no;
+    int seat_no;
+};
+
+/* In-memory user directory, loaded once from users.txt.
+   Open-addressing hash table (linear probing) keyed by username.
+   Each entry also indexes the seats currently booked by that account. */
+struct user_entry {
+    char username[CURRENT_USER_LEN];
+    char password[PASSWORD_LEN];
+    struct seat_ref *bookings;
+    int n_bookings;
+    int cap_bookings;
+};
+struct user_entry *user_table = NULL;
+size_t user_table_size = 0; /* number of slots, power of two */
+size_t user_count = 0;
+
+/* Passenger index: the booked seats of every passenger name, kept in sync
+   by set_seat(). Open-addressing hash table like the user directory; a
+   name keeps its slot (with no seats) after its last seat is freed. */
+struct passenger_entry {
+    char *name; /* NULL for an unused slot */
+    struct seat_ref *seats;
+    int n_seats;
+    int cap_seats;
+};
+struct passenger_entry *passenger_table = NULL;
+size_t passenger_table_size = 0; /* number of slots, power of two */
+size_t passenger_count = 0;
+
+/* Booking history (bookings.txt), one event per line:
+   <date> <time> <book|cancel> <bus> <seat> <user or -> <passenger name> */
+FILE *history_log = NULL;
+
+/* When 0, seat changes stay in memory and no status file is read or written
+   (used by --bench so measuring does not touch real bookings). */
+int persist_changes = 1;
+
+/* Activity counters for this run, shown to admin via "View Statistics" */
+struct run_stats {
+    long seats_booked;
+    long seats_cancelled;
+    long logins_ok;
+    long logins_failed;
+    long seat_conflicts;
+    long status_reads;
+    long status_writes;
+    long status_bytes_written;
+    long log_writes;
+    long log_bytes_written;
+};
+struct run_stats stats = {0};
+
+/* Function prototypes */
+int load_fleet();
+char **bus_seats(int bus_no);
+char *copy_name(const char *name);
+int valid_passenger_name(const char *name);
+void set_seat(int bus_no, int seat_no, const char *name, const char *owner);
+void load_all_buses();
+void reload_bus_status(int bus_no);
+void refresh_bus_status(int bus_no);
+void remember_file_state(int bus_no);
+int lock_bus(int bus_no);
+void unlock_bus(int bus_no);
+int claim_seats(int bus_no, const int seats[], char names[][MAX_NAME_LEN], int n, const char *user);
+int release_seat(int bus_no, int seat_no, char *name_out, size_t outlen, const char *user);
+int release_seats(int bus_no, const int seats[], int n, const char *owner, const char *user, int results[], char names[][MAX_NAME_LEN]);
+int add_to_waitlist(int bus_no, const char *user, const char *name);
+int promote_from_waitlist(int bus_no, int seat_no, int skip);
+int drop_from_waitlist(int bus_no, int count);
+void record_promotion(int bus_no, int seat_no);
+int authenticate_user(const char *username, const char *password);
+int run_batch(const char *in_path, const char *out_path);
+int run_benchmark(long iterations, long extra_users);
+void show_statistics();
+void show_my_bookings(struct session *s);
+void cancel_my_bookings(struct session *s);
+void find_passenger_bookings();
+struct passenger_entry *find_passenger(const char *name);
+void record_history(const char *action, int bus_no, int seat_no, const char *user, const char *name);
+void close_history_log();
+void show_seat_history();
+int import_history(int extra_count, char *extra_users[]);
+int run_check(int repair);
+void main_menu();
+void view_bus_list();
+void book_tickets(struct session *s);
+void cancel_booking(struct session *s);
+void show_bus_status();
+void show_bus_status_quiet(int bus_no); /* internal use */
+int count_available_seats(int bus_no);
+int find_seats_together(int bus_no, int num, int preference, int seats_out[]);
+void read_status_into_array(int bus_no, int *count);
+void parse_status_file(FILE *f, int bus_no);
+int find_status_tmp(int bus_no, char *out, size_t len);
+int write_status_from_array(int bus_no, char *status[], int count);
+void register_user();
+int login_user(struct session *s);
+void pause_console();
+void clear_screen();
+void load_users();
+int split_user_line(char *line, char user[CURRENT_USER_LEN], const char **password);
+struct user_entry *find_user(const char *username);
+static unsigned long hash_username(const char *s);
+int add_user_to_table(const char *username, const char *password);
+int sanitize_username(const char *in, char *out, size_t outlen);
+void append_user_log(struct session *s, const char *fmt, ...);
+void close_user_log(struct session *s);
+void get_timestamp(char *buf, size_t len);
+
+int main(int argc, char *argv[]) {
+    /* all data files live in one directory, so several independent copies
+       (e.g. one per group of buses) can run side by side */
+    if (argc >= 3 && strcmp(argv[1], "--data-dir") == 0) {
+        if (change_dir(argv[2]) != 0) {
+            printf("Cannot use data directory %s\n", argv[2]);
+            return 1;
+        }
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+    if (!load_fleet()) return 1;
+    load_users(); /* before the buses, so their owners can be indexed */
+    load_all_buses();
+    if (argc >= 3 && strcmp(argv[1], "--batch") == 0) {
+        int rc = run_batch(argv[2], argc >= 4 ? argv[3] : NULL);
+        close_history_log();
+        return rc;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0) {
+        return run_benchmark(argc >= 3 ? atol(argv[2]) : 100000, argc >= 4 ? atol(argv[3]) : 0);
+    }
+    if (argc >= 2 && strcmp(argv[1], "--import-history") == 0) {
+        return import_history(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && (strcmp(argv[1], "--check") == 0 || strcmp(argv[1], "--repair") == 0)) {
+        int rc = run_check(strcmp(argv[1], "--repair") == 0);
+        close_history_log();
+        return rc;
+    }
+    main_menu();
+    close_history_log();
+    return 0;
+}
+
+/* Load the fleet from buses.txt (written with the default fleet if missing)
+   and allocate the shared seat array. Returns 1 on success, 0 on error. */
+int load_fleet() {
+    FILE *f = fopen(FLEET_FILE, "r");
+    if (!f) {
+        f = fopen(FLEET_FILE, "w");
+        if (f) {
+            fprintf(f, "# seats seats_per_row name\n");
+            for (int i = 0; i < DEFAULT_BUSES; ++i) {
+                fprintf(f, "%d %d %s\n", DEFAULT_SEATS, DEFAULT_SEATS_PER_ROW, default_bus_names[i]);
+            }
+            fclose(f);
+        }
+        f = fopen(FLEET_FILE, "r");
+        if (!f) {
+            printf("Cannot open fleet file %s\n", FLEET_FILE);
+            return 0;
+        }
+    }
+
+    int capacity = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+        int seats = 0, per_row = 0, used = 0;
+        if (sscanf(line, "%d %d %n", &seats, &per_row, &used) < 2 || seats < 1 || per_row < 1 || line[used] == '\0') {
+            printf("Skipping invalid line in %s: %s\n", FLEET_FILE, line);
+            continue;
+        }
+        if (bus_count == capacity) {
+            int new_capacity = capacity ? capacity * 2 : 16;
+            struct bus_info *grown = realloc(fleet, new_capacity * sizeof(struct bus_info));
+            if (!grown) {
+                fclose(f);
+                printf("Out of memory loading %s\n", FLEET_FILE);
+                return 0;
+            }
+            fleet = grown;
+            capacity = new_capacity;
+        }
+        struct bus_info *b = &fleet[bus_count++];
+        strncpy(b->name, line + used, BUS_NAME_LEN-1);
+        b->name[BUS_NAME_LEN-1] = '\0';
+        b->seats = seats;
+        b->seats_per_row = per_row;
+        b->first_seat = total_seats;
+        total_seats += seats;
+    }
+    fclose(f);
+
+    if (bus_count == 0) {
+        printf("No buses defined in %s\n", FLEET_FILE);
+        return 0;
+    }
+    seat_status = calloc((size_t)total_seats, sizeof(char *));
+    seat_owner = calloc((size_t)total_seats, sizeof(char *));
+    if (!seat_status || !seat_owner) {
+        printf("Out of memory allocating %d seats\n", total_seats);
+        return 0;
+    }
+    return 1;
+}
+
+/* Seat list of one bus inside seat_status (index 0 is seat 1) */
+char **bus_seats(int bus_no) {
+    return seat_status + fleet[bus_no-1].first_seat;
+}
+
+/* Heap copy of a passenger name, cut to MAX_NAME_LEN-1 characters.
+   Exits on allocation failure, since seat state could not be kept. */
+char *copy_name(const char *name) {
+    size_t len = strlen(name);
+    if (len > MAX_NAME_LEN-1) len = MAX_NAME_LEN-1;
+    char *p = malloc(len + 1);
+    if (!p) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+    memcpy(p, name, len);
+    p[len] = '\0';
+    /* tabs separate name and owner in the status files */
+    for (char *c = p; *c; ++c) {
+        if (*c == '\t') *c = ' ';
+    }
+    return p;
+}
+
+/* A passenger name must not be empty or "Empty", which marks a free seat
+   in the status files (a seat booked under that name would read back as
+   free and be sold again). Returns 1 if name can be booked. */
+int valid_passenger_name(const char *name) {
+    return name[0] != '\0' && strcmp(name, "Empty") != 0;
+}
+
+/* Add a seat to, or remove it from, a list of seat references */
+static void update_seat_refs(struct seat_ref **refs, int *n, int *cap, int bus_no, int seat_no, int add) {
+    if (add) {
+        if (*n == *cap) {
+            int new_cap = *cap ? *cap * 2 : 4;
+            struct seat_ref *grown = realloc(*refs, (size_t)new_cap * sizeof(struct seat_ref));
+            if (!grown) return;
+            *refs = grown;
+            *cap = new_cap;
+        }
+        (*refs)[*n].bus_no = bus_no;
+        (*refs)[*n].seat_no = seat_no;
+        (*n)++;
+        return;
+    }
+    for (int i = 0; i < *n; ++i) {
+        if ((*refs)[i].bus_no == bus_no && (*refs)[i].seat_no == seat_no) {
+            (*refs)[i] = (*refs)[--(*n)];
+            return;
+        }
+    }
+}
+
+/* Add or remove a seat in its owner's booking index (owners that are not
+   registered users are simply not indexed) */
+static void index_booking(const char *owner, int bus_no, int seat_no, int add) {
+    struct user_entry *e = find_user(owner);
+    if (!e) return;
+    update_seat_refs(&e->bookings, &e->n_bookings, &e->cap_bookings, bus_no, seat_no, add);
+}
+
+/* Look up a passenger name in the passenger index; NULL if never booked */
+struct passenger_entry *find_passenger(const char *name) {
+    if (passenger_table_size == 0) return NULL;
+    size_t mask = passenger_table_size - 1;
+    for (size_t i = hash_username(name) & mask; passenger_table[i].name; i = (i + 1) & mask) {
+        if (strcmp(passenger_table[i].name, name) == 0) return &passenger_table[i];
+    }
+    return NULL;
+}
+
+/* Double the passenger index (or create it) and re-insert its entries */
+static int grow_passenger_table() {
+    size_t new_size = passenger_table_size ? passenger_table_size * 2 : USER_TABLE_MIN_SIZE;
+    struct passenger_entry *new_table = calloc(new_size, sizeof(struct passenger_entry));
+    if (!new_table) return 0;
+    for (size_t i = 0; i < passenger_table_size; ++i) {
+        if (!passenger_table[i].name) continue;
+        size_t j = hash_username(passenger_table[i].name) & (new_size - 1);
+        while (new_table[j].name) j = (j + 1) & (new_size - 1);
+        new_table[j] = passenger_table[i];
+    }
+    free(passenger_table);
+    passenger_table = new_table;
+    passenger_table_size = new_size;
+    return 1;
+}
+
+/* Add or remove a seat in the passenger index under a passenger name */
+static void index_passenger(const char *name, int bus_no, int seat_no, int add) {
+    struct passenger_entry *e = find_passenger(name);
+    if (!e) {
+        if (!add) return;
+        /* keep load factor below 3/4, as for the user directory */
+        if ((passenger_count + 1) * 4 > passenger_table_size * 3 && !grow_passenger_table()) return;
+        size_t mask = passenger_table_size - 1;
+        size_t i = hash_username(name) & mask;
+        while (passenger_table[i].name) i = (i + 1) & mask;
+        e = &passenger_table[i];
+        e->name = copy_name(name);
+        passenger_count++;
+    }
+    update_seat_refs(&e->seats, &e->n_seats, &e->cap_seats, bus_no, seat_no, add);
+}
+
+/* Set a seat to passenger name booked by owner, or empty it (name NULL),
+   keeping the owners' booking indexes and the passenger index in sync */
+void set_seat(int bus_no, int seat_no, const char *name, const char *owner) {
+    int i = fleet[bus_no-1].first_seat + seat_no - 1;
+    if (seat_owner[i]) {
+        index_booking(seat_owner[i], bus_no, seat_no, 0);
+        free(seat_owner[i]);
+        seat_owner[i] = NULL;
+    }
+    if (seat_status[i]) index_passenger(seat_status[i], bus_no, seat_no, 0);
+    free(seat_status[i]);
+    seat_status[i] = NULL;
+    if (!name) return;
+    seat_status[i] = copy_name(name);
+    index_passenger(seat_status[i], bus_no, seat_no, 1);
+    if (owner && owner[0]) {
+        seat_owner[i] = copy_name(owner);
+        index_booking(owner, bus_no, seat_no, 1);
+    }
+}
+
+/* Load every bus status file into seat_status, opening each file once.
+   A missing status file is created with all seats empty. */
+void load_all_buses() {
+    for (int i = 1; i <= bus_count; ++i) {
+        char status_fname[64], tmp_fname[64];
+        snprintf(status_fname, sizeof(status_fname), "bus%d_status.txt", i);
+
+        stats.status_reads++;
+        FILE *fst = fopen(status_fname, "r");
+        if (!fst && find_status_tmp(i, tmp_fname, sizeof(tmp_fname)) && rename(tmp_fname, status_fname) == 0) {
+            /* crashed between removing the old file and renaming the new one
+               (Windows path in write_status_from_array): the .tmp is complete */
+            fst = fopen(status_fname, "r");
+        }
+        if (fst) {
+            parse_status_file(fst, i);
+            fclose(fst);
+            remember_file_state(i);
+        } else {
+            /* seats start out NULL (empty); write the "Empty" lines */
+            write_status_from_array(i, bus_seats(i), fleet[i-1].seats);
+        }
+    }
+}
+
+/* Record the status file's current modification time and size */
+void remember_file_state(int bus_no) {
+    char fname[64];
+    struct stat st;
+    snprintf(fname, sizeof(fname), "bus%d_status.txt", bus_no);
+    if (stat(fname, &st) == 0) {
+        fleet[bus_no-1].file_mtime = st.st_mtime;
+        fleet[bus_no-1].file_size = (long)st.st_size;
+        fleet[bus_no-1].file_seen = time(NULL);
+    }
+}
+
+/* Re-read a bus's status file only if it changed since we last read or
+   wrote it (another running copy booked or cancelled). Used for display;
+   claim_seats/release_seat always re-read.
+   mtime has 1 s resolution and a change can keep the size ("Empty" ->
+   "Priya"), so mtime and size only prove the file unchanged if it was
+   last modified in an earlier second than the one we looked at it in.
+   A file written in that same second is always re-read. */
+void refresh_bus_status(int bus_no) {
+    if (!persist_changes) return;
+    char fname[64];
+    struct stat st;
+    snprintf(fname, sizeof(fname), "bus%d_status.txt", bus_no);
+    if (stat(fname, &st) != 0) return;
+    if (st.st_mtime == fleet[bus_no-1].file_mtime && (long)st.st_size == fleet[bus_no-1].file_size
+        && st.st_mtime < fleet[bus_no-1].file_seen) return;
+    reload_bus_status(bus_no);
+}
+
+/* Re-read one bus's status file into seat_status */
+void reload_bus_status(int bus_no) {
+    if (!persist_changes) return;
+    int count = 0;
+    read_status_into_array(bus_no, &count);
+}
+
+/* Take a bus's lock file (busN_status.lock). It is created exclusively, so
+   only one running copy at a time goes from re-reading the status file to
+   renaming the new one in, and two copies can never both sell a seat or
+   overwrite each other's bookings. The bus's waitlist is changed under the
+   same lock. Waits while another copy holds it; a lock file older than
+   LOCK_STALE_SECS is taken to be left by a crashed copy and removed.
+   Returns 1 when the lock is held, 0 if it could not be taken. */
+int lock_bus(int bus_no) {
+    if (!persist_changes) return 1;
+    char fname[64];
+    snprintf(fname, sizeof(fname), "bus%d_status.lock", bus_no);
+    for (int waited = 0; ; waited += 10) {
+        FILE *f = fopen(fname, "wx");
+        if (f) {
+            fprintf(f, "%ld\n", (long)get_pid());
+            fclose(f);
+            return 1;
+        }
+        struct stat st;
+        if (stat(fname, &st) == 0 && time(NULL) - st.st_mtime > LOCK_STALE_SECS) {
+            remove(fname);
+            continue;
+        }
+        if (waited >= LOCK_WAIT_MS) {
+            printf("Bus %d is busy (%s is held), please try again.\n", bus_no, fname);
+            return 0;
+        }
+        sleep_ms(10);
+    }
+}
+
+/* Release a lock taken with lock_bus() */
+void unlock_bus(int bus_no) {
+    if (!persist_changes) return;
+    char fname[64];
+    snprintf(fname, sizeof(fname), "bus%d_status.lock", bus_no);
+    remove(fname);
+}
+
+/* Book n seats on a bus as one unit: under the bus lock, the status file is
+   re-read and either every seat is still empty and all are written, or
+   nothing changes.
+   user (NULL if none) is recorded as the booking account in the history.
+   Returns 0 on success, the first seat number that is no longer free, or
+   -1 if the status file could not be saved (no seat is booked). */
+int claim_seats(int bus_no, const int seats[], char names[][MAX_NAME_LEN], int n, const char *user) {
+    char **status = bus_seats(bus_no);
+    if (!lock_bus(bus_no)) return -1;
+    reload_bus_status(bus_no);
+    for (int k = 0; k < n; ++k) {
+        if (status[seats[k]-1]) {
+            stats.seat_conflicts++;
+            unlock_bus(bus_no);
+            return seats[k];
+        }
+    }
+    for (int k = 0; k < n; ++k) set_seat(bus_no, seats[k], names[k], user);
+    if (!write_status_from_array(bus_no, status, fleet[bus_no-1].seats)) {
+        for (int k = 0; k < n; ++k) set_seat(bus_no, seats[k], NULL, NULL);
+        unlock_bus(bus_no);
+        return -1;
+    }
+    unlock_bus(bus_no);
+    for (int k = 0; k < n; ++k) record_history("book", bus_no, seats[k], user, names[k]);
+    stats.seats_booked += n;
+    return 0;
+}
+
+/* Cancel one seat (see release_seats). Returns 0 if the seat was already
+   empty, -1 if the status file could not be saved or the bus lock not
+   taken (the booking is kept), otherwise copies the cancelled passenger's
+   name into name_out (if given) and returns 1, 2 when the seat was handed
+   to a waitlisted passenger, or 3 when it was but that passenger could not
+   be taken off the waitlist (they are still listed). */
+int release_seat(int bus_no, int seat_no, char *name_out, size_t outlen, const char *user) {
+    int result = 0;
+    char name[1][MAX_NAME_LEN];
+    if (release_seats(bus_no, &seat_no, 1, NULL, user, &result, name) < 0) return -1;
+    if (result && name_out && outlen > 0) snprintf(name_out, outlen, "%s", name[0]);
+    return result;
+}
+
+/* Cancel n seats of a bus as one unit, like claim_seats: under the bus
+   lock the status file is re-read once, each seat is checked, freed seats
+   go to the bus's waitlisted passengers, and the file is written once;
+   if the write fails nothing changes. A seat is cancelled only if it is
+   booked and, when owner is given, booked by that account (another copy
+   may have rebooked it for someone else). Waitlisted passengers are taken
+   off the list only after the write. user is recorded in the history.
+   results[k] gets 0 (skipped), 1 (cancelled), 2 (given to a waitlisted
+   passenger) or 3 (given, but the waitlist could not be updated) and
+   names[k] the cancelled passenger.
+   Returns the number of seats cancelled, or -1 if nothing was saved. */
+int release_seats(int bus_no, const int seats[], int n, const char *owner, const char *user, int results[], char names[][MAX_NAME_LEN]) {
+    char **status = bus_seats(bus_no);
+    char **owners = seat_owner + fleet[bus_no-1].first_seat;
+    /* keep each booking's account so it can be put back if saving fails */
+    char (*old_owner)[CURRENT_USER_LEN] = malloc((size_t)n * CURRENT_USER_LEN);
+    if (!old_owner) {
+        printf("Out of memory.\n");
+        return -1;
+    }
+    if (!lock_bus(bus_no)) {
+        free(old_owner);
+        return -1;
+    }
+    reload_bus_status(bus_no);
+
+    int cancelled = 0, promoted = 0;
+    for (int k = 0; k < n; ++k) {
+        int seat_no = seats[k];
+        results[k] = 0;
+        if (!status[seat_no-1]) continue;
+        if (owner && (!owners[seat_no-1] || strcmp(owners[seat_no-1], owner) != 0)) continue;
+        snprintf(names[k], MAX_NAME_LEN, "%s", status[seat_no-1]);
+        snprintf(old_owner[k], CURRENT_USER_LEN, "%s", owners[seat_no-1] ? owners[seat_no-1] : "");
+        set_seat(bus_no, seat_no, NULL, NULL);
+        results[k] = 1;
+        if (promote_from_waitlist(bus_no, seat_no, promoted)) {
+            promoted++;
+            results[k] = 2;
+        }
+        cancelled++;
+    }
+    if (cancelled && !write_status_from_array(bus_no, status, fleet[bus_no-1].seats)) {
+        for (int k = n - 1; k >= 0; --k) {
+            if (results[k]) set_seat(bus_no, seats[k], names[k], old_owner[k]);
+        }
+        unlock_bus(bus_no);
+        free(old_owner);
+        return -1;
+    }
+
+    for (int k = 0; k < n; ++k) {
+        if (!results[k]) continue;
+        record_history("cancel", bus_no, seats[k], user, names[k]);
+        stats.seats_cancelled++;
+        if (results[k] == 2) record_promotion(bus_no, seats[k]);
+    }
+    if (promoted && !drop_from_waitlist(bus_no, promoted)) {
+        for (int k = 0; k < n; ++k) {
+            if (results[k] == 2) results[k] = 3;
+        }
+    }
+    unlock_bus(bus_no);
+    free(old_owner);
+    return cancelled;
+}
+
+/* Add a passenger to the end of a bus's waitlist (busN_waitlist.txt, one
+   "<user or -> <passenger name>" line per entry, first line is next).
+   Returns the passenger's position in the queue, or 0 on error. */
+int add_to_waitlist(int bus_no, const char *user, const char *name) {
+    if (!valid_passenger_name(name)) return 0;
+    char fname[64];
+    snprintf(fname, sizeof(fname), "bus%d_waitlist.txt", bus_no);
+    if (!lock_bus(bus_no)) return 0;
+    int pos = 1;
+    FILE *f = fopen(fname, "r");
+    if (f) {
+        char line[256];
+        while (fgets(line, sizeof(line), f)) {
+            if (line[0] != '\n') pos++;
+        }
+        fclose(f);
+    }
+    f = fopen(fname, "a");
+    if (f) {
+        fprintf(f, "%s %s\n", user && user[0] ? user : "-", name);
+        if (fclose(f) != 0) pos = 0;
+    } else {
+        pos = 0;
+    }
+    unlock_bus(bus_no);
+    return pos;
+}
+
+/* Split a waitlist line into its account ("-" if none) and passenger name,
+   with the name cut and cleaned the way copy_name() stores it.
+   Returns 1 if the line is a valid entry. */
+static int parse_waitlist_line(char *line, char user[CURRENT_USER_LEN], char name[MAX_NAME_LEN]) {
+    int used = 0;
+    line[strcspn(line, "\r\n")] = '\0';
+    if (sscanf(line, "%63s %n", user, &used) != 1 || line[used] == '\0') return 0;
+    snprintf(name, MAX_NAME_LEN, "%s", line + used);
+    for (char *c = name; *c; ++c) {
+        if (*c == '\t') *c = ' ';
+    }
+    return 1;
+}
+
+/* Give an empty seat to the first passenger on the bus's waitlist, after
+   skipping the skip passengers already seated but not yet dropped. Only
+   updates the in-memory seat: the caller saves the status file and then
+   calls drop_from_waitlist(), all under the bus lock, so a failed save or
+   a crash can leave a seated passenger still listed, but never drops one
+   without a seat. Returns 1 if a passenger was seated, 0 if none waiting. */
+int promote_from_waitlist(int bus_no, int seat_no, int skip) {
+    if (!persist_changes) return 0;
+    char fname[64];
+    snprintf(fname, sizeof(fname), "bus%d_waitlist.txt", bus_no);
+    FILE *f = fopen(fname, "r");
+    if (!f) return 0;
+
+    char line[256], user[CURRENT_USER_LEN], name[MAX_NAME_LEN];
+    int found = 0;
+    while (!found && fgets(line, sizeof(line), f)) {
+        if (parse_waitlist_line(line, user, name) && skip-- == 0) found = 1;
+    }
+    fclose(f);
+    if (!found) return 0;
+    set_seat(bus_no, seat_no, name, strcmp(user, "-") == 0 ? NULL : user);
+    return 1;
+}
+
+/* Record the booking of a passenger promote_from_waitlist() seated */
+void record_promotion(int bus_no, int seat_no) {
+    int idx = fleet[bus_no-1].first_seat + seat_no - 1;
+    record_history("book", bus_no, seat_no, seat_owner[idx], seat_status[idx]);
+    stats.seats_booked++;
+}
+
+/* Take the first count passengers off the bus's waitlist, once the status
+   file seating them has been saved (the lock has been held since they were
+   promoted, so they are still the first entries).
+   Returns 1 on success, 0 if the waitlist could not be rewritten: the
+   seated passengers are then still listed and the caller must report it,
+   since promoting again would seat them twice. */
+int drop_from_waitlist(int bus_no, int count) {
+    char fname[64], tmp_fname[64];
+    snprintf(fname, sizeof(fname), "bus%d_waitlist.txt", bus_no);
+    snprintf(tmp_fname, sizeof(tmp_fname), "bus%d_waitlist.%ld.tmp", bus_no, (long)get_pid());
+    FILE *f = fopen(fname, "r");
+    if (!f) return 1; /* nothing left to drop */
+    FILE *rest = fopen(tmp_fname, "w");
+    if (!rest) {
+        fclose(f);
+        printf("Error updating waitlist for bus %d\n", bus_no);
+        return 0;
+    }
+
+    /* copy every line except the seated passengers' entries */
+    char line[256], copy[256], user[CURRENT_USER_LEN], name[MAX_NAME_LEN];
+    while (fgets(line, sizeof(line), f)) {
+        if (count > 0) {
+            strcpy(copy, line);
+            if (parse_waitlist_line(copy, user, name)) {
+                count--;
+                continue;
+            }
+        }
+        fputs(line, rest);
+    }
+    fclose(f);
+    if (fclose(rest) != 0) {
+        printf("Error updating waitlist for bus %d\n", bus_no);
+        remove(tmp_fname);
+        return 0;
+    }
+    #ifdef _WIN32
+        remove(fname); /* rename() does not replace an existing file on Windows */
+    #endif
+    if (rename(tmp_fname, fname) != 0) {
+        printf("Error updating waitlist for bus %d\n", bus_no);
+        remove(tmp_fname);
+        return 0;
+    }
+    return 1;
+}
+
+/* One line of a batch file, held until its group is applied */
+struct batch_op {
+    int line_no;
+    int cancel;                  /* 0 book, 1 cancel */
+    int seat_no;
+    char name[MAX_NAME_LEN];     /* passenger to book, or the one cancelled */
+    char owner[CURRENT_USER_LEN]; /* account of the cancelled booking */
+    int result;                  /* 1 done, 2 done and seat given to the
+                                    waitlist, 0 seat taken/empty */
+    char promoted_name[MAX_NAME_LEN];      /* waitlisted passenger seated */
+    char promoted_owner[CURRENT_USER_LEN]; /* and their account, "" if none */
+};
+
+/* Apply a group of batch lines for one bus under a single lock: one
+   re-read, every line checked against the current seats in order, one
+   write. If the write fails, none of the group's changes are kept. */
+static void apply_batch_group(FILE *out, int bus_no, struct batch_op ops[], int n, int *ok_count, int *fail_count) {
+    char **status = bus_seats(bus_no);
+    if (!lock_bus(bus_no)) {
+        for (int k = 0; k < n; ++k) fprintf(out, "%d FAIL bus %d is busy\n", ops[k].line_no, bus_no);
+        *fail_count += n;
+        return;
+    }
+    reload_bus_status(bus_no);
+    int changed = 0, promoted = 0;
+    for (int k = 0; k < n; ++k) {
+        struct batch_op *op = &ops[k];
+        char **seat = &status[op->seat_no-1];
+        op->result = 0;
+        if (!op->cancel) {
+            if (*seat) {
+                stats.seat_conflicts++;
+                continue;
+            }
+            set_seat(bus_no, op->seat_no, op->name, NULL);
+            op->result = 1;
+        } else {
+            if (!*seat) continue;
+            char **owner = &seat_owner[fleet[bus_no-1].first_seat + op->seat_no - 1];
+            snprintf(op->name, sizeof(op->name), "%s", *seat);
+            snprintf(op->owner, sizeof(op->owner), "%s", *owner ? *owner : "");
+            set_seat(bus_no, op->seat_no, NULL, NULL);
+            op->result = 1;
+            if (promote_from_waitlist(bus_no, op->seat_no, promoted)) {
+                snprintf(op->promoted_name, sizeof(op->promoted_name), "%s", *seat);
+                snprintf(op->promoted_owner, sizeof(op->promoted_owner), "%s", *owner ? *owner : "");
+                promoted++;
+                op->result = 2;
+            }
+        }
+        changed = 1;
+    }
+
+    if (changed && !write_status_from_array(bus_no, status, fleet[bus_no-1].seats)) {
+        /* undo in reverse order, so a seat booked and cancelled in the
+           same group ends up as it was before */
+        for (int k = n - 1; k >= 0; --k) {
+            if (!ops[k].result) continue;
+            if (ops[k].cancel) set_seat(bus_no, ops[k].seat_no, ops[k].name, ops[k].owner);
+            else set_seat(bus_no, ops[k].seat_no, NULL, NULL);
+        }
+        unlock_bus(bus_no);
+        for (int k = 0; k < n; ++k) fprintf(out, "%d FAIL bus %d seat %d could not be saved\n", ops[k].line_no, bus_no, ops[k].seat_no);
+        *fail_count += n;
+        return;
+    }
+
+    /* saved: take the seated passengers off the waitlist, record history in
+       line order, then report each line */
+    int dropped = !promoted || drop_from_waitlist(bus_no, promoted);
+    for (int k = 0; k < n; ++k) {
+        struct batch_op *op = &ops[k];
+        if (!op->result) {
+            fprintf(out, "%d FAIL bus %d seat %d already %s\n", op->line_no, bus_no, op->seat_no, op->cancel ? "empty" : "booked");
+            (*fail_count)++;
+            continue;
+        }
+        (*ok_count)++;
+        if (!op->cancel) {
+            record_history("book", bus_no, op->seat_no, NULL, op->name);
+            stats.seats_booked++;
+            fprintf(out, "%d OK booked bus %d seat %d\n", op->line_no, bus_no, op->seat_no);
+            continue;
+        }
+        record_history("cancel", bus_no, op->seat_no, NULL, op->name);
+        stats.seats_cancelled++;
+        if (op->result == 2) {
+            record_history("book", bus_no, op->seat_no, op->promoted_owner[0] ? op->promoted_owner : NULL, op->promoted_name);
+            stats.seats_booked++;
+            fprintf(out, "%d OK cancelled bus %d seat %d, given to waitlisted %s\n", op->line_no, bus_no, op->seat_no, op->promoted_name);
+            if (!dropped) fprintf(out, "%d WARN %s is seated but still on the waitlist of bus %d\n", op->line_no, op->promoted_name, bus_no);
+        } else {
+            fprintf(out, "%d OK cancelled bus %d seat %d\n", op->line_no, bus_no, op->seat_no);
+        }
+    }
+    unlock_bus(bus_no);
+}
+
+/* Apply a file of booking operations without prompts, one per line:
+       book <bus> <seat> <passenger name>
+       cancel <bus> <seat>
+   Blank lines and lines starting with '#' are skipped. One result line per
+   operation goes to out_path (or stdout). Consecutive lines for the same
+   bus (up to BATCH_GROUP_MAX) are applied together under the bus lock, with
+   one re-read and one write (see apply_batch_group), so changes made by
+   other running copies are seen and never overwritten.
+   Returns 0 if every operation succeeded, 1 otherwise. */
+int run_batch(const char *in_path, const char *out_path) {
+    FILE *in = fopen(in_path, "r");
+    if (!in) {
+        printf("Cannot open batch file %s\n", in_path);
+        return 1;
+    }
+    FILE *out = stdout;
+    if (out_path) {
+        out = fopen(out_path, "w");
+        if (!out) {
+            printf("Cannot open result file %s\n", out_path);
+            fclose(in);
+            return 1;
+        }
+    }
+    struct batch_op *ops = malloc(BATCH_GROUP_MAX * sizeof(struct batch_op));
+    if (!ops) {
+        printf("Out of memory.\n");
+        fclose(in);
+        if (out != stdout) fclose(out);
+        return 1;
+    }
+
+    int line_no = 0, ok_count = 0, fail_count = 0;
+    int group_bus = 0, n_ops = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), in)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+
+        char op[16];
+        int bus_no = 0, seat_no = 0, used = 0;
+        const char *error = NULL;
+        if (sscanf(line, "%15s %d %d %n", op, &bus_no, &seat_no, &used) < 3) error = "malformed line";
+        else if (bus_no < 1 || bus_no > bus_count || seat_no < 1 || seat_no > fleet[bus_no-1].seats) error = "invalid bus or seat";
+        else if (strcmp(op, "book") != 0 && strcmp(op, "cancel") != 0) error = "unknown operation";
+        else if (strcmp(op, "book") == 0 && line[used] == '\0') error = "missing passenger name";
+        else if (strcmp(op, "book") == 0 && !valid_passenger_name(line + used)) error = "passenger name \"Empty\" is reserved";
+
+        /* a line for another bus, a full group or an error ends the group,
+           so results stay in line order */
+        if (n_ops > 0 && (error || bus_no != group_bus || n_ops == BATCH_GROUP_MAX)) {
+            apply_batch_group(out, group_bus, ops, n_ops, &ok_count, &fail_count);
+            n_ops = 0;
+        }
+        if (error) {
+            if (strcmp(error, "unknown operation") == 0) fprintf(out, "%d FAIL unknown operation '%s'\n", line_no, op);
+            else fprintf(out, "%d FAIL %s\n", line_no, error);
+            fail_count++;
+            continue;
+        }
+        group_bus = bus_no;
+        ops[n_ops].line_no = line_no;
+        ops[n_ops].cancel = strcmp(op, "cancel") == 0;
+        ops[n_ops].seat_no = seat_no;
+        snprintf(ops[n_ops].name, sizeof(ops[n_ops].name), "%s", ops[n_ops].cancel ? "" : line + used);
+        n_ops++;
+    }
+    if (n_ops > 0) apply_batch_group(out, group_bus, ops, n_ops, &ok_count, &fail_count);
+    free(ops);
+    fclose(in);
+    if (out != stdout) fclose(out);
+    printf("Batch done: %d succeeded, %d failed.\n", ok_count, fail_count);
+    return fail_count ? 1 : 0;
+}
+
+/* Print one benchmark result line: name, operations, seconds, ops/sec */
+static void report_bench(const char *name, long ops, clock_t start) {
+    double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("%s %ld %.6f %.0f\n", name, ops, secs, secs > 0 ? ops / secs : 0.0);
+}
+
+/* Time the core operations behind the menus. Seat changes are kept in
+   memory only and undone, so the data files are never modified.
+   extra_users adds that many generated accounts to the in-memory directory. */
+int run_benchmark(long iterations, long extra_users) {
+    if (iterations < 1) iterations = 1;
+    persist_changes = 0;
+
+    for (long i = 0; i < extra_users; ++i) {
+        char u[CURRENT_USER_LEN];
+        snprintf(u, sizeof(u), "bench_user_%ld", i);
+        add_user_to_table(u, "pw");
+    }
+    printf("# users %lu buses %d seats %d\n", (unsigned long)user_count, bus_count, total_seats);
+    printf("# operation ops seconds ops_per_sec\n");
+
+    volatile long sink = 0;
+    clock_t start = clock();
+    for (long i = 0; i < iterations; ++i) {
+        sink += authenticate_user("admin", "adminpass");
+    }
+    report_bench("login", iterations, start);
+
+    char name[1][MAX_NAME_LEN] = {"Bench"};
+    long pairs = 0;
+    start = clock();
+    for (long i = 0; i < iterations; ++i) {
+        int bus_no = (int)(i % bus_count) + 1;
+        int seat = (int)((i / bus_count) % fleet[bus_no-1].seats) + 1;
+        if (claim_seats(bus_no, &seat, name, 1, NULL) == 0) {
+            release_seat(bus_no, seat, NULL, 0, NULL);
+            pairs++;
+        }
+    }
+    report_bench("book_cancel", pairs, start);
+
+    start = clock();
+    for (long i = 0; i < iterations; ++i) {
+        for (int b = 1; b <= bus_count; ++b) sink += count_available_seats(b);
+    }
+    report_bench("bus_list", iterations, start);
+
+    (void)sink;
+    return 0;
+}
+
+/* Clear the terminal. Uses ANSI escape codes instead of running the
+   external clear command; Windows consoles still get "cls". */
+void clear_screen() {
+    #ifdef _WIN32
+        system("cls");
+    #else
+        fputs("\033[H\033[2J", stdout);
+        fflush(stdout);
+    #endif
+}
+
+/* Pause helper */
+void pause_console() {
+    printf("\nPress Enter to continue...");
+    int c;
+    /* consume leftover input until newline */
+    while ((c = getchar()) != '\n' && c != EOF) {}
+}
+
+/* Main menu with login/registration flow */
+void main_menu() {
+    struct session session = {{0}, NULL};
+    int logged_in = 0;
+    char choice[8];
+
+    while (1) {
+        clear_screen();
+
+        printf("====================================== WELCOME TO BUS RESERVATION SYSTEM ======================================\n\n");
+        printf("Please choose an option:\n");
+        printf(" 1) Login\n");
+        printf(" 2) Register (create new user)\n");
+        printf(" 3) View Bus List (no login required)\n");
+        printf(" 4) Exit\n");
+        printf("\nEnter choice: ");
+        if (!fgets(choice, sizeof(choice), stdin)) return;
+        int opt = atoi(choice);
+
+        if (opt == 1) {
+            logged_in = login_user(&session);
+            if (logged_in) {
+                /* After login, show user menu */
+                int user_opt = 0;
+                while (1) {
+                    clear_screen();
+
+                    printf("Logged in as: %s\n", session.user);
+                    printf("Choose action:\n");
+                    printf(" 1) View Bus List\n");
+                    printf(" 2) Book Tickets\n");
+                    printf(" 3) Cancel Booking\n");
+                    printf(" 4) View Bus Status\n");
+                    printf(" 5) Logout\n");
+                    printf(" 6) My Bookings\n");
+                    printf(" 7) Cancel All My Bookings on a Bus\n");
+                    if (strcmp(session.user, "admin") == 0) {
+                        printf(" 8) View Statistics\n");
+                        printf(" 9) Seat Booking History\n");
+                        printf(" 10) Find Passenger\n");
+                    }
+                    printf("Enter choice: ");
+                    if (!fgets(choice, sizeof(choice), stdin)) {
+                        close_user_log(&session);
+                        return;
+                    }
+                    user_opt = atoi(choice);
+                    if (user_opt == 1) view_bus_list();
+                    else if (user_opt == 2) book_tickets(&session);
+                    else if (user_opt == 3) cancel_booking(&session);
+                    else if (user_opt == 4) show_bus_status();
+                    else if (user_opt == 6) show_my_bookings(&session);
+                    else if (user_opt == 7) cancel_my_bookings(&session);
+                    else if (user_opt == 8 && strcmp(session.user, "admin") == 0) show_statistics();
+                    else if (user_opt == 9 && strcmp(session.user, "admin") == 0) show_seat_history();
+                    else if (user_opt == 10 && strcmp(session.user, "admin") == 0) find_passenger_bookings();
+                    else if (user_opt == 5) {
+                        /* append logout entry to user file and end the session */
+                        if (session.user[0] != '\0') {
+                            append_user_log(&session, "Logged out");
+                            close_user_log(&session);
+                            session.user[0] = '\0';
+                        }
+                        break;
+                    }
+                    else printf("Invalid choice.\n");
+                    pause_console();
+                }
+            } else {
+                printf("Login failed.\n");
+                pause_console();
+            }
+        } else if (opt == 2) {
+            register_user();
+            pause_console();
+        } else if (opt == 3) {
+            view_bus_list();
+            pause_console();
+        } else if (opt == 4) {
+            printf("Thank you for using the system!\n");
+            break;
+        } else {
+            printf("Invalid option. Try again.\n");
+            pause_console();
+        }
+    }
+}
+
+/* Show the list of buses and available seats */
+void view_bus_list() {
+    clear_screen();
+
+    printf("=========================================== BUS LIST ============================================\n\n");
+    for (int i = 0; i < bus_count; ++i) {
+        refresh_bus_status(i+1);
+        int avail = count_available_seats(i+1);
+        printf(" [%d] %s   - Available seats: %d\n", i+1, fleet[i].name, avail);
+    }
+}
+
+/* Booking flow */
+void book_tickets(struct session *s) {
+    char input[16];
+    view_bus_list();
+    printf("\nEnter bus number to book: ");
+    if (!fgets(input, sizeof(input), stdin)) return;
+    int bus_no = atoi(input);
+    if (bus_no < 1 || bus_no > bus_count) {
+        printf("Invalid bus number.\n");
+        return;
+    }
+
+    /* pick up bookings made meanwhile by another running copy of the program */
+    refresh_bus_status(bus_no);
+    int avail = count_available_seats(bus_no);
+    if (avail <= 0) {
+        printf("No seats available on this bus.\n");
+        printf("Join the waitlist? A seat is assigned automatically when one is cancelled (y/n): ");
+        if (!fgets(input, sizeof(input), stdin) || (input[0] != 'y' && input[0] != 'Y')) return;
+        printf("Enter passenger name: ");
+        char name_in[MAX_NAME_LEN];
+        if (!fgets(name_in, sizeof(name_in), stdin)) return;
+        name_in[strcspn(name_in, "\n")] = '\0';
+        if (!valid_passenger_name(name_in)) {
+            printf("Name cannot be empty or \"Empty\".\n");
+            return;
+        }
+        int pos = add_to_waitlist(bus_no, s->user, name_in);
+        if (pos <= 0) {
+            printf("Could not join the waitlist.\n");
+            return;
+        }
+        printf("%s added to the waitlist of %s at position %d.\n", name_in, fleet[bus_no-1].name, pos);
+        append_user_log(s, "Waitlisted: Bus %d Name: %s", bus_no, name_in);
+        return;
+    }
+
+    printf("You selected: %s (Available seats: %d)\n", fleet[bus_no-1].name, avail);
+    printf("How many tickets do you want to book (1-%d)? ", avail);
+    if (!fgets(input, sizeof(input), stdin)) return;
+    int num = atoi(input);
+    if (num < 1 || num > avail) {
+        printf("Invalid ticket count.\n");
+        return;
+    }
+
+    /* seats are only held locally until all of them are chosen, then claimed together */
+    char **status = bus_seats(bus_no);
+    int seat_count = fleet[bus_no-1].seats;
+    int *seats = malloc((size_t)num * sizeof(int));
+    char (*names)[MAX_NAME_LEN] = malloc((size_t)num * MAX_NAME_LEN);
+    if (!seats || !names) {
+        printf("Out of memory.\n");
+        free(seats);
+        free(names);
+        return;
+    }
+    int booked = 0;
+
+    /* optionally let the system pick seats next to each other */
+    int auto_assign = 0;
+    printf("Seat selection: 1) choose seats myself  2) auto-assign seats together: ");
+    if (!fgets(input, sizeof(input), stdin)) input[0] = '\0';
+    if (atoi(input) == 2) {
+        printf("Preference: 1) window  2) aisle  3) any: ");
+        if (!fgets(input, sizeof(input), stdin)) input[0] = '\0';
+        int pref = atoi(input);
+        if (pref != PREFER_WINDOW && pref != PREFER_AISLE) pref = PREFER_ANY;
+        auto_assign = find_seats_together(bus_no, num, pref, seats);
+        if (auto_assign) {
+            printf("Assigned seats:");
+            for (int k = 0; k < num; ++k) printf(" %d", seats[k]);
+            printf("\n");
+        } else {
+            printf("Could not auto-assign seats, please choose them yourself.\n");
+        }
+    }
+
+    for (int t = 0; t < num; ++t) {
+        int seat_choice = 0;
+        if (auto_assign) {
+            seat_choice = seats[booked];
+        } else {
+            printf("\nEnter seat number to book (1-%d): ", seat_count);
+            if (!fgets(input, sizeof(input), stdin)) break;
+            seat_choice = atoi(input);
+        }
+        if (seat_choice < 1 || seat_choice > seat_count) {
+            printf("Invalid seat number. Try again.\n");
+            t--; /* retry this ticket */
+            continue;
+        }
+        /* check if seat is empty and not already picked in this booking */
+        if (status[seat_choice-1]) {
+            stats.seat_conflicts++;
+            printf("Seat %d is already booked by %s. Choose a different seat.\n", seat_choice, status[seat_choice-1]);
+            t--;
+            continue;
+        }
+        int picked = 0;
+        for (int k = 0; k < booked; ++k) {
+            if (seats[k] == seat_choice) picked = 1;
+        }
+        if (picked) {
+            printf("Seat %d is already part of this booking. Choose a different seat.\n", seat_choice);
+            t--;
+            continue;
+        }
+        printf("Enter passenger name for seat %d: ", seat_choice);
+        char name_in[MAX_NAME_LEN];
+        if (!fgets(name_in, sizeof(name_in), stdin)) break;
+        /* trim newline */
+        name_in[strcspn(name_in, "\n")] = '\0';
+        if (!valid_passenger_name(name_in)) {
+            printf("Name cannot be empty or \"Empty\". Try again.\n");
+            t--;
+            continue;
+        }
+        seats[booked] = seat_choice;
+        snprintf(names[booked], MAX_NAME_LEN, "%s", name_in);
+        booked++;
+    }
+
+    /* claim all chosen seats at once (seats chosen before input ended early are kept) */
+    int conflict = booked ? claim_seats(bus_no, seats, names, booked, s->user) : 0;
+    if (booked == 0 || conflict) {
+        if (conflict < 0) printf("\nThe booking could not be saved. No seats were booked, please try again.\n");
+        else if (conflict) printf("\nSeat %d was just booked by someone else. No seats were booked, please try again.\n", conflict);
+        free(seats);
+        free(names);
+        return;
+    }
+
+    for (int k = 0; k < booked; ++k) {
+        printf("Seat %d booked for %s.\n", seats[k], names[k]);
+
+        /* append booking to the user's file (if logged in) */
+        append_user_log(s, "Booked: Bus %d Seat %d Name: %s", bus_no, seats[k], names[k]);
+    }
+
+    free(seats);
+    free(names);
+    printf("\nBooking complete. Total charge: Rs %d\n", 200 * booked);
+}
+
+/* Cancel booking */
+void cancel_booking(struct session *s) {
+    char input[16];
+    view_bus_list();
+    printf("\nEnter bus number for cancellation: ");
+    if (!fgets(input, sizeof(input), stdin)) return;
+    int bus_no = atoi(input);
+    if (bus_no < 1 || bus_no > bus_count) {
+        printf("Invalid bus number.\n");
+        return;
+    }
+
+    refresh_bus_status(bus_no);
+    show_bus_status_quiet(bus_no); /* shows seat map */
+
+    printf("\nEnter seat number to cancel: ");
+    if (!fgets(input, sizeof(input), stdin)) return;
+    int seat_no = atoi(input);
+    if (seat_no < 1 || seat_no > fleet[bus_no-1].seats) {
+        printf("Invalid seat number.\n");
+        return;
+    }
+
+    char passenger[MAX_NAME_LEN];
+    int released = release_seat(bus_no, seat_no, passenger, sizeof(passenger), s->user);
+    if (released < 0) {
+        printf("The cancellation could not be saved. Seat %d is still booked, please try again.\n", seat_no);
+        return;
+    }
+    if (!released) {
+        printf("Seat %d is already empty.\n", seat_no);
+        return;
+    }
+    printf("Cancelled seat %d booked by %s\n", seat_no, passenger);
+    if (released >= 2) {
+        printf("Seat %d has been given to waitlisted passenger %s.\n", seat_no, bus_seats(bus_no)[seat_no-1]);
+    }
+    if (released == 3) {
+        printf("Warning: the waitlist of bus %d could not be updated; %s is still listed.\n", bus_no, bus_seats(bus_no)[seat_no-1]);
+        append_user_log(s, "Waitlist not updated: Bus %d Seat %d", bus_no, seat_no);
+    }
+
+    /* append cancellation to the user's file (if logged in) */
+    append_user_log(s, "Cancelled: Bus %d Seat %d", bus_no, seat_no);
+
+    printf("Cancellation successful. Rs 200 will be refunded (simulated).\n");
+}
+
+/* List the seats booked by the logged-in account, from its booking index.
+   Only the buses the index names are refreshed; seats booked for this
+   account by another running copy on other buses show once those buses
+   are next read. */
+void show_my_bookings(struct session *s) {
+    struct user_entry *e = find_user(s->user);
+    if (e && e->n_bookings > 0) {
+        /* copy the buses first: a refresh rebuilds their part of the index */
+        int *buses = malloc((size_t)e->n_bookings * sizeof(int));
+        if (!buses) {
+            printf("Out of memory.\n");
+            return;
+        }
+        int n = 0;
+        for (int i = 0; i < e->n_bookings; ++i) {
+            int seen = 0;
+            for (int k = 0; k < n && !seen; ++k) seen = buses[k] == e->bookings[i].bus_no;
+            if (!seen) buses[n++] = e->bookings[i].bus_no;
+        }
+        for (int k = 0; k < n; ++k) refresh_bus_status(buses[k]);
+        free(buses);
+    }
+    if (!e || e->n_bookings == 0) {
+        printf("\nYou have no bookings.\n");
+        return;
+    }
+    printf("\n===== My Bookings =====\n");
+    for (int i = 0; i < e->n_bookings; ++i) {
+        int bus_no = e->bookings[i].bus_no, seat_no = e->bookings[i].seat_no;
+        printf(" %-20s Seat %2d  %s\n", fleet[bus_no-1].name, seat_no, bus_seats(bus_no)[seat_no-1]);
+    }
+}
+
+/* Cancel every seat the logged-in account holds on one bus */
+void cancel_my_bookings(struct session *s) {
+    char input[16];
+    view_bus_list();
+    printf("\nEnter bus number to cancel all your bookings on: ");
+    if (!fgets(input, sizeof(input), stdin)) return;
+    int bus_no = atoi(input);
+    if (bus_no < 1 || bus_no > bus_count) {
+        printf("Invalid bus number.\n");
+        return;
+    }
+
+    refresh_bus_status(bus_no);
+    struct user_entry *e = find_user(s->user);
+    if (!e || e->n_bookings == 0) {
+        printf("You have no bookings on %s.\n", fleet[bus_no-1].name);
+        return;
+    }
+    /* copy the seats first: releasing them edits the index */
+    int *seats = malloc((size_t)e->n_bookings * sizeof(int));
+    if (!seats) {
+        printf("Out of memory.\n");
+        return;
+    }
+    int n = 0;
+    for (int i = 0; i < e->n_bookings; ++i) {
+        if (e->bookings[i].bus_no == bus_no) seats[n++] = e->bookings[i].seat_no;
+    }
+    if (n == 0) {
+        printf("You have no bookings on %s.\n", fleet[bus_no-1].name);
+        free(seats);
+        return;
+    }
+
+    /* one re-read and one write for all of them; seats rebooked for
+       another account in the meantime are left alone */
+    int *results = malloc((size_t)n * sizeof(int));
+    char (*passengers)[MAX_NAME_LEN] = malloc((size_t)n * MAX_NAME_LEN);
+    if (!results || !passengers) {
+        printf("Out of memory.\n");
+        free(results);
+        free(passengers);
+        free(seats);
+        return;
+    }
+    int cancelled = release_seats(bus_no, seats, n, s->user, s->user, results, passengers);
+    int saved = cancelled >= 0;
+    if (!saved) {
+        printf("The cancellation could not be saved. Your seats are still booked, please try again.\n");
+        cancelled = 0;
+    }
+    for (int i = 0; saved && i < n; ++i) {
+        if (!results[i]) {
+            printf("Seat %d is no longer booked by you; skipped.\n", seats[i]);
+            continue;
+        }
+        printf("Cancelled seat %d booked by %s\n", seats[i], passengers[i]);
+        if (results[i] >= 2) {
+            printf("Seat %d has been given to waitlisted passenger %s.\n", seats[i], bus_seats(bus_no)[seats[i]-1]);
+        }
+        if (results[i] == 3) {
+            printf("Warning: the waitlist of bus %d could not be updated; %s is still listed.\n", bus_no, bus_seats(bus_no)[seats[i]-1]);
+            append_user_log(s, "Waitlist not updated: Bus %d Seat %d", bus_no, seats[i]);
+        }
+        append_user_log(s, "Cancelled: Bus %d Seat %d", bus_no, seats[i]);
+    }
+    free(results);
+    free(passengers);
+    free(seats);
+    printf("Cancelled %d seat(s). Rs %d will be refunded (simulated).\n", cancelled, cancelled * 200);
+}
+
+/* Admin: list the booked seats of a passenger name, from the passenger
+   index. Only the buses the index names are refreshed. */
+void find_passenger_bookings() {
+    char name_in[MAX_NAME_LEN];
+    printf("\nEnter passenger name (exact): ");
+    if (!fgets(name_in, sizeof(name_in), stdin)) return;
+    name_in[strcspn(name_in, "\n")] = '\0';
+
+    struct passenger_entry *e = find_passenger(name_in);
+    if (e && e->n_seats > 0) {
+        /* copy the buses first: a refresh rebuilds their part of the index */
+        int *buses = malloc((size_t)e->n_seats * sizeof(int));
+        if (!buses) {
+            printf("Out of memory.\n");
+            return;
+        }
+        int n = 0;
+        for (int i = 0; i < e->n_seats; ++i) {
+            int seen = 0;
+            for (int k = 0; k < n && !seen; ++k) seen = buses[k] == e->seats[i].bus_no;
+            if (!seen) buses[n++] = e->seats[i].bus_no;
+        }
+        for (int k = 0; k < n; ++k) refresh_bus_status(buses[k]);
+        free(buses);
+        e = find_passenger(name_in); /* the index may have grown */
+    }
+    if (!e || e->n_seats == 0) {
+        printf("No bookings for %s.\n", name_in);
+        return;
+    }
+    printf("\n===== Bookings for %s =====\n", name_in);
+    for (int i = 0; i < e->n_seats; ++i) {
+        int bus_no = e->seats[i].bus_no, seat_no = e->seats[i].seat_no;
+        const char *owner = seat_owner[fleet[bus_no-1].first_seat + seat_no - 1];
+        printf(" %-20s Seat %2d  booked by %s\n", fleet[bus_no-1].name, seat_no, owner ? owner : "-");
+    }
+}
+
+/* Admin view of this run's activity counters */
+void show_statistics() {
+    printf("\n===== Statistics (since program start) =====\n");
+    printf(" Seats booked         : %ld\n", stats.seats_booked);
+    printf(" Seats cancelled      : %ld\n", stats.seats_cancelled);
+    printf(" Successful logins    : %ld\n", stats.logins_ok);
+    printf(" Failed logins        : %ld\n", stats.logins_failed);
+    printf(" Seat conflicts       : %ld\n", stats.seat_conflicts);
+    printf(" Status file reads    : %ld\n", stats.status_reads);
+    printf(" Status file writes   : %ld (%ld bytes)\n", stats.status_writes, stats.status_bytes_written);
+    printf(" User log writes      : %ld (%ld bytes)\n", stats.log_writes, stats.log_bytes_written);
+    printf(" Registered users     : %lu\n", (unsigned long)user_count);
+}
+
+/* Append one event to bookings.txt (kept open until exit) */
+void record_history(const char *action, int bus_no, int seat_no, const char *user, const char *name) {
+    if (!persist_changes) return;
+    if (!history_log) {
+        history_log = fopen(HISTORY_FILE, "a");
+        if (!history_log) return;
+    }
+    char ts[64];
+    get_timestamp(ts, sizeof(ts));
+    fprintf(history_log, "%s %s %d %d %s %s\n", ts, action, bus_no, seat_no,
+            user && user[0] ? user : "-", name ? name : "");
+    fflush(history_log);
+}
+
+void close_history_log() {
+    if (!history_log) return;
+    fclose(history_log);
+    history_log = NULL;
+}
+
+/* Admin: list every booking/cancel event of one seat from bookings.txt */
+void show_seat_history() {
+    char input[16];
+    printf("\nEnter bus number: ");
+    if (!fgets(input, sizeof(input), stdin)) return;
+    int bus_no = atoi(input);
+    printf("Enter seat number: ");
+    if (!fgets(input, sizeof(input), stdin)) return;
+    int seat_no = atoi(input);
+
+    FILE *f = fopen(HISTORY_FILE, "r");
+    if (!f) {
+        printf("No booking history yet.\n");
+        return;
+    }
+    printf("\nHistory of Bus %d Seat %d:\n", bus_no, seat_no);
+    char line[256];
+    int found = 0;
+    while (fgets(line, sizeof(line), f)) {
+        int b = 0, st = 0;
+        if (sscanf(line, "%*s %*s %*s %d %d", &b, &st) == 2 && b == bus_no && st == seat_no) {
+            printf(" %s", line);
+            found++;
+        }
+    }
+    fclose(f);
+    if (!found) printf(" (no bookings recorded)\n");
+}
+
+/* qsort helper: history lines start with a sortable timestamp */
+static int compare_lines(const void *a, const void *b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* One-time import: build bookings.txt from the Booked/Cancelled entries
+   in every registered user's <username>.txt log (plus any extra names
+   given, for logs of users no longer in users.txt), sorted by time.
+   Refuses to run if bookings.txt already has content. */
+int import_history(int extra_count, char *extra_users[]) {
+    FILE *f = fopen(HISTORY_FILE, "r");
+    if (f) {
+        int has_content = fgetc(f) != EOF;
+        fclose(f);
+        if (has_content) {
+            printf("%s already exists; import only builds a new history.\n", HISTORY_FILE);
+            return 1;
+        }
+    }
+
+    size_t n_users = user_count + (size_t)extra_count;
+    const char **names = malloc((n_users ? n_users : 1) * sizeof(char *));
+    if (!names) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    size_t k = 0;
+    for (size_t i = 0; i < user_table_size; ++i) {
+        if (user_table[i].username[0] != '\0') names[k++] = user_table[i].username;
+    }
+    for (int i = 0; i < extra_count; ++i) {
+        if (!find_user(extra_users[i])) names[k++] = extra_users[i];
+    }
+
+    char **lines = NULL;
+    size_t n_lines = 0, cap = 0;
+    int out_of_memory = 0;
+    for (size_t u = 0; u < k && !out_of_memory; ++u) {
+        char fname[128];
+        snprintf(fname, sizeof(fname), "%s.txt", names[u]);
+        FILE *uf = fopen(fname, "r");
+        if (!uf) continue;
+        char line[256];
+        while (fgets(line, sizeof(line), uf)) {
+            line[strcspn(line, "\r\n")] = '\0';
+            char date[16], time_s[16], out[384];
+            int bus_no = 0, seat_no = 0, used = 0;
+            if (sscanf(line, "%15s %15s - Booked: Bus %d Seat %d Name: %n", date, time_s, &bus_no, &seat_no, &used) == 4 && used > 0) {
+                snprintf(out, sizeof(out), "%s %s book %d %d %s %s", date, time_s, bus_no, seat_no, names[u], line + used);
+            } else if (sscanf(line, "%15s %15s - Cancelled: Bus %d Seat %d", date, time_s, &bus_no, &seat_no) == 4) {
+                snprintf(out, sizeof(out), "%s %s cancel %d %d %s ", date, time_s, bus_no, seat_no, names[u]);
+            } else {
+                continue;
+            }
+            if (n_lines == cap) {
+                size_t new_cap = cap ? cap * 2 : 256;
+                char **grown = realloc(lines, new_cap * sizeof(char *));
+                if (!grown) {
+                    out_of_memory = 1;
+                    break;
+                }
+                lines = grown;
+                cap = new_cap;
+            }
+            lines[n_lines] = malloc(strlen(out) + 1);
+            if (!lines[n_lines]) {
+                out_of_memory = 1;
+                break;
+            }
+            strcpy(lines[n_lines++], out);
+        }
+        fclose(uf);
+    }
+    free(names);
+
+    f = NULL;
+    if (out_of_memory) printf("Out of memory; %s was not written.\n", HISTORY_FILE);
+    else if (!(f = fopen(HISTORY_FILE, "w"))) printf("Cannot write %s\n", HISTORY_FILE);
+    if (!f) {
+        for (size_t i = 0; i < n_lines; ++i) free(lines[i]);
+        free(lines);
+        return 1;
+    }
+    qsort(lines, n_lines, sizeof(char *), compare_lines);
+    for (size_t i = 0; i < n_lines; ++i) {
+        fprintf(f, "%s\n", lines[i]);
+        free(lines[i]);
+    }
+    fclose(f);
+    free(lines);
+    printf("Imported %lu booking events into %s.\n", (unsigned long)n_lines, HISTORY_FILE);
+    return 0;
+}
+
+/* Check the data files for inconsistencies and, with repair set, fix them:
+   - busN_status.txt must have exactly one line per seat, none blank
+     (rewritten from the loaded seats, which are already padded/truncated)
+   - users.txt must not contain malformed lines or duplicate usernames
+     (duplicates are dropped, keeping the first entry of each user;
+     malformed lines are only reported, so no account is ever removed)
+   - a waitlist must be empty while its bus has free seats
+     (waiting passengers are seated in the free seats)
+   - user logs and bookings.txt must only mention existing buses and seats
+     (reported only, since they are history)
+   Returns 0 if the data is consistent (or was fully repaired), 1 otherwise. */
+int run_check(int repair) {
+    int problems = 0, fixed = 0;
+    char line[256];
+
+    for (int b = 1; b <= bus_count; ++b) {
+        /* while repairing, hold the bus lock so no other copy writes in between */
+        if (repair && !lock_bus(b)) {
+            problems++;
+            continue;
+        }
+        if (repair) reload_bus_status(b);
+        char fname[64];
+        snprintf(fname, sizeof(fname), "bus%d_status.txt", b);
+        FILE *f = fopen(fname, "r");
+        int lines = 0, blanks = 0;
+        while (f && fgets(line, sizeof(line), f)) {
+            lines++;
+            if (line[0] == '\n' || line[0] == '\r') blanks++;
+        }
+        if (f) fclose(f);
+        if (lines != fleet[b-1].seats || blanks > 0) {
+            printf("%s: %d lines (%d blank), expected %d seats\n", fname, lines, blanks, fleet[b-1].seats);
+            problems++;
+            if (repair && write_status_from_array(b, bus_seats(b), fleet[b-1].seats)) fixed++;
+        }
+
+        /* seat waiting passengers in the free seats, save them, and only
+           then take them off the list */
+        int promoted = 0;
+        int *seated = repair ? malloc((size_t)fleet[b-1].seats * sizeof(int)) : NULL;
+        for (int i = 1; seated && i <= fleet[b-1].seats; ++i) {
+            if (!bus_seats(b)[i-1] && promote_from_waitlist(b, i, promoted)) seated[promoted++] = i;
+        }
+        if (promoted && !write_status_from_array(b, bus_seats(b), fleet[b-1].seats)) {
+            for (int k = 0; k < promoted; ++k) set_seat(b, seated[k], NULL, NULL);
+            promoted = 0;
+            problems++; /* left on the waitlist, reported by the write */
+        }
+        for (int k = 0; k < promoted; ++k) record_promotion(b, seated[k]);
+        free(seated);
+        if (promoted && !drop_from_waitlist(b, promoted)) {
+            /* running --repair again would seat them a second time */
+            printf("bus%d_waitlist.txt: %d passenger(s) seated but not removed from the list; remove the first %d entries by hand\n", b, promoted, promoted);
+            problems++;
+        } else if (promoted) {
+            printf("bus%d_waitlist.txt: %d waiting passenger(s) seated in free seats\n", b, promoted);
+            problems++;
+            fixed++;
+        } else if (!repair && count_available_seats(b) > 0) {
+            snprintf(fname, sizeof(fname), "bus%d_waitlist.txt", b);
+            f = fopen(fname, "r");
+            int waiting = 0;
+            while (f && fgets(line, sizeof(line), f)) {
+                if (line[0] != '\n') waiting++;
+            }
+            if (f) fclose(f);
+            if (waiting) {
+                printf("%s: %d passenger(s) waiting although the bus has free seats\n", fname, waiting);
+                problems++;
+            }
+        }
+        if (repair) unlock_bus(b);
+    }
+
+    /* users.txt: malformed lines and duplicates (first entry wins, as in load_users) */
+    FILE *f = fopen(USER_FILE, "r");
+    char **kept = NULL;
+    size_t n_kept = 0, cap = 0, n_lines = 0;
+    int bad_users = 0, dup_users = 0, out_of_memory = 0;
+    while (f && fgets(line, sizeof(line), f)) n_lines++;
+    if (f) rewind(f);
+    /* names already seen, in a table at least twice the line count */
+    size_t seen_size = USER_TABLE_MIN_SIZE;
+    while (seen_size < n_lines * 2) seen_size *= 2;
+    struct user_entry *seen = calloc(seen_size, sizeof(struct user_entry));
+    if (f && !seen) out_of_memory = 1;
+    while (f && seen && !out_of_memory && fgets(line, sizeof(line), f)) {
+        char u[CURRENT_USER_LEN], clean[CURRENT_USER_LEN];
+        const char *pw;
+        int dup = 0;
+        if (!split_user_line(line, u, &pw)
+            || !sanitize_username(u, clean, sizeof(clean)) || strcmp(clean, u) != 0) {
+            printf("%s: malformed line \"%s\"\n", USER_FILE, line);
+            bad_users++;
+        } else {
+            size_t mask = seen_size - 1, i = hash_username(u) & mask;
+            for (; seen[i].username[0] != '\0'; i = (i + 1) & mask) {
+                if (strcmp(seen[i].username, u) == 0) dup = 1;
+            }
+            if (dup) {
+                printf("%s: duplicate user \"%s\"\n", USER_FILE, u);
+                dup_users++;
+                continue;
+            }
+            strcpy(seen[i].username, u);
+        }
+        /* every line but a duplicate is kept as it is */
+        if (n_kept == cap) {
+            size_t new_cap = cap ? cap * 2 : 64;
+            char **grown = realloc(kept, new_cap * sizeof(char *));
+            if (!grown) {
+                out_of_memory = 1;
+                break;
+            }
+            kept = grown;
+            cap = new_cap;
+        }
+        kept[n_kept] = malloc(strlen(line) + 1);
+        if (!kept[n_kept]) {
+            out_of_memory = 1;
+            break;
+        }
+        strcpy(kept[n_kept++], line);
+    }
+    if (f) fclose(f);
+    problems += bad_users + dup_users;
+    if (out_of_memory) printf("Out of memory; %s was not checked completely.\n", USER_FILE);
+    else if (dup_users && repair) {
+        /* write the new list to a temp file and swap it in, so a failed
+           write never leaves users.txt truncated */
+        char tmp_fname[64];
+        snprintf(tmp_fname, sizeof(tmp_fname), "users.%ld.tmp", (long)get_pid());
+        FILE *out = fopen(tmp_fname, "w");
+        int ok = out != NULL;
+        for (size_t i = 0; out && i < n_kept; ++i) {
+            if (fprintf(out, "%s\n", kept[i]) < 0) ok = 0;
+        }
+        if (out && (fflush(out) != 0 || sync_file(out) != 0)) ok = 0;
+        if (out && fclose(out) != 0) ok = 0;
+        #ifdef _WIN32
+            if (ok) remove(USER_FILE); /* rename() does not replace an existing file on Windows */
+        #endif
+        if (ok && rename(tmp_fname, USER_FILE) == 0) {
+            fixed += dup_users;
+        } else {
+            printf("Error writing %s; it was left unchanged.\n", USER_FILE);
+            remove(tmp_fname);
+        }
+    }
+    for (size_t i = 0; i < n_kept; ++i) free(kept[i]);
+    free(kept);
+    free(seen);
+
+    /* user logs: every booking must name an existing bus and seat */
+    for (size_t i = 0; i < user_table_size; ++i) {
+        if (user_table[i].username[0] == '\0') continue;
+        char fname[128];
+        snprintf(fname, sizeof(fname), "%s.txt", user_table[i].username);
+        f = fopen(fname, "r");
+        int line_no = 0;
+        while (f && fgets(line, sizeof(line), f)) {
+            int b = 0, st = 0;
+            line_no++;
+            if (sscanf(line, "%*s %*s - %*s Bus %d Seat %d", &b, &st) == 2
+                && (b < 1 || b > bus_count || st < 1 || st > fleet[b-1].seats)) {
+                printf("%s:%d: refers to missing Bus %d Seat %d\n", fname, line_no, b, st);
+                problems++;
+            }
+        }
+        if (f) fclose(f);
+    }
+
+    /* bookings.txt: same check */
+    close_history_log();
+    f = fopen(HISTORY_FILE, "r");
+    int line_no = 0;
+    while (f && fgets(line, sizeof(line), f)) {
+        int b = 0, st = 0;
+        line_no++;
+        if (sscanf(line, "%*s %*s %*s %d %d", &b, &st) != 2
+            || b < 1 || b > bus_count || st < 1 || st > fleet[b-1].seats) {
+            printf("%s:%d: invalid entry or missing bus/seat\n", HISTORY_FILE, line_no);
+            problems++;
+        }
+    }
+    if (f) fclose(f);
+
+    printf("Check done: %d problem(s) found, %d fixed.\n", problems, fixed);
+    return problems > fixed ? 1 : 0;
+}
+
+/* Show seat status in a nice grid */
+void show_bus_status() {
+    char input[16];
+    view_bus_list();
+    printf("\nEnter bus number to view status: ");
+    if (!fgets(input, sizeof(input), stdin)) return;
+    int bus_no = atoi(input);
+    if (bus_no < 1 || bus_no > bus_count) {
+        printf("Invalid bus number.\n");
+        return;
+    }
+    refresh_bus_status(bus_no);
+    show_bus_status_quiet(bus_no);
+}
+
+/* Internal function to print status */
+void show_bus_status_quiet(int bus_no) {
+    char **status = bus_seats(bus_no);
+    int seat_count = fleet[bus_no-1].seats;
+    int per_row = fleet[bus_no-1].seats_per_row;
+
+    /* build the whole map in one buffer and print it with a single call;
+       a seat cell is at most 11 digits + '.' + 10 name chars + 2 tabs */
+    size_t cap = (size_t)seat_count * 32 + (size_t)(seat_count / per_row + 1) * 4 + 256;
+    char *buf = malloc(cap);
+    if (!buf) {
+        printf("Out of memory.\n");
+        return;
+    }
+    size_t len = 0;
+    len += snprintf(buf + len, cap - len, "\nBus %d --> %s\n", bus_no, fleet[bus_no-1].name);
+    len += snprintf(buf + len, cap - len, "--------------------------------------------------------------------------------\n");
+    int index = 0;
+    while (index < seat_count) {
+        buf[len++] = '\t';
+        for (int col = 0; col < per_row && index < seat_count; ++col) {
+            int seat = index + 1;
+            if (!status[index])
+                len += snprintf(buf + len, cap - len, "%2d.Empty\t\t", seat);
+            else /* print up to 10 chars of name for compact view */
+                len += snprintf(buf + len, cap - len, "%2d.%.10s\t", seat, status[index]);
+            index++;
+        }
+        buf[len++] = '\n';
+    }
+    buf[len] = '\0';
+    fputs(buf, stdout);
+    free(buf);
+}
+
+/* 1 if column col of a row with per_row seats matches the window/aisle preference */
+static int seat_matches_preference(int col, int per_row, int preference) {
+    if (preference == PREFER_WINDOW) return col == 0 || col == per_row - 1;
+    if (preference == PREFER_AISLE) return col == (per_row - 1) / 2 || col == per_row / 2;
+    return 1;
+}
+
+/* Pick num empty seats that sit together on the seat map, using the same
+   rows as show_bus_status_quiet. First choice is a run of adjacent seats in
+   one row (the earliest run including a preferred window/aisle seat, else
+   the earliest run). Otherwise the fewest consecutive rows holding num empty
+   seats are used. Seat numbers go to seats_out in order.
+   Returns 1 if seats were found, 0 if the bus has fewer than num empty seats. */
+int find_seats_together(int bus_no, int num, int preference, int seats_out[]) {
+    char **status = bus_seats(bus_no);
+    int seat_count = fleet[bus_no-1].seats;
+    int per_row = fleet[bus_no-1].seats_per_row;
+    int rows = (seat_count + per_row - 1) / per_row;
+    if (num < 1 || count_available_seats(bus_no) < num) return 0;
+
+    /* same row: look at every run of num adjacent empty seats */
+    int first_run = -1, preferred_run = -1;
+    for (int row = 0; row < rows && num <= per_row && preferred_run < 0; ++row) {
+        int first = row * per_row;
+        int last = first + per_row < seat_count ? first + per_row : seat_count;
+        int run = 0;
+        for (int i = first; i < last && preferred_run < 0; ++i) {
+            run = status[i] ? 0 : run + 1;
+            if (run < num) continue;
+            int start = i - num + 1;
+            if (first_run < 0) first_run = start;
+            for (int k = start; k <= i; ++k) {
+                if (seat_matches_preference(k - first, per_row, preference)) preferred_run = start;
+            }
+        }
+    }
+    int start = preferred_run >= 0 ? preferred_run : first_run;
+    if (start >= 0) {
+        for (int k = 0; k < num; ++k) seats_out[k] = start + k + 1;
+        return 1;
+    }
+
+    /* otherwise: smallest block of consecutive rows with num empty seats */
+    int best_first = 0, best_rows = rows + 1;
+    for (int top = 0; top < rows; ++top) {
+        int empty = 0;
+        for (int row = top; row < rows && row - top + 1 < best_rows; ++row) {
+            for (int i = row * per_row; i < (row + 1) * per_row && i < seat_count; ++i) {
+                if (!status[i]) empty++;
+            }
+            if (empty >= num) {
+                best_first = top;
+                best_rows = row - top + 1;
+                break;
+            }
+        }
+    }
+    int n = 0;
+    for (int i = best_first * per_row; i < seat_count && n < num; ++i) {
+        if (!status[i]) seats_out[n++] = i + 1;
+    }
+    return n == num;
+}
+
+/* Count empty seats of a bus from its in-memory status.
+   The count is always derived, so it can never disagree with the seat list. */
+int count_available_seats(int bus_no) {
+    char **status = bus_seats(bus_no);
+    int avail = 0;
+    for (int i = 0; i < fleet[bus_no-1].seats; ++i) {
+        if (!status[i]) avail++;
+    }
+    return avail;
+}
+
+/* Re-read a bus's status file into its seats (see parse_status_file).
+   If the file cannot be read, the seats are left unchanged.
+   count is filled with number of seats of the bus. */
+void read_status_into_array(int bus_no, int *count) {
+    int seat_count = fleet[bus_no-1].seats;
+    char fname[64];
+    snprintf(fname, sizeof(fname), "bus%d_status.txt", bus_no);
+    stats.status_reads++;
+    *count = seat_count;
+    FILE *f = fopen(fname, "r");
+    if (f) {
+        parse_status_file(f, bus_no);
+        fclose(f);
+        remember_file_state(bus_no);
+        return;
+    }
+    /* Never treat an unreadable file as "every seat empty": keep the seats
+       we already have. On Windows the file is briefly missing while another
+       copy swaps in a new version (remove, then rename); its .tmp is
+       complete at that point, so read that instead. */
+    #ifdef _WIN32
+        char tmp_fname[64];
+        if (find_status_tmp(bus_no, tmp_fname, sizeof(tmp_fname))) {
+            f = fopen(tmp_fname, "r");
+            if (f) {
+                parse_status_file(f, bus_no);
+                fclose(f);
+            }
+        }
+    #endif
+}
+
+/* Find a finished temp status file of a bus, "busN_status.<pid>.tmp", left
+   by a copy that was swapping it in (see write_status_from_array). If there
+   are several, the most recently modified one is taken.
+   Returns 1 and copies its name into out, or 0 if there is none. */
+int find_status_tmp(int bus_no, char *out, size_t len) {
+    char prefix[32];
+    int plen = snprintf(prefix, sizeof(prefix), "bus%d_status.", bus_no);
+    time_t newest = 0;
+    int found = 0;
+    #ifdef _WIN32
+        char pattern[48];
+        struct _finddata_t fd;
+        snprintf(pattern, sizeof(pattern), "%s*.tmp", prefix);
+        intptr_t h = _findfirst(pattern, &fd);
+        if (h == -1) return 0;
+        do {
+            if (!found || fd.time_write > newest) {
+                snprintf(out, len, "%s", fd.name);
+                newest = fd.time_write;
+                found = 1;
+            }
+        } while (_findnext(h, &fd) == 0);
+        _findclose(h);
+    #else
+        DIR *dir = opendir(".");
+        if (!dir) return 0;
+        struct dirent *de;
+        while ((de = readdir(dir)) != NULL) {
+            size_t n = strlen(de->d_name);
+            struct stat st;
+            if (strncmp(de->d_name, prefix, (size_t)plen) != 0) continue;
+            if (n < (size_t)plen + 4 || strcmp(de->d_name + n - 4, ".tmp") != 0) continue;
+            if (stat(de->d_name, &st) != 0) continue;
+            if (!found || st.st_mtime > newest) {
+                snprintf(out, len, "%s", de->d_name);
+                newest = st.st_mtime;
+                found = 1;
+            }
+        }
+        closedir(dir);
+    #endif
+    (void)plen;
+    return found;
+}
+
+/* Load a bus's seats from the lines of an open status file
+   ("<name>" or "<name>\t<owner>"); blank or "Empty" lines and seats
+   missing from a short file become empty. */
+void parse_status_file(FILE *f, int bus_no) {
+    int seat_count = fleet[bus_no-1].seats;
+    char line[256];
+    int idx = 0;
+    while (idx < seat_count && fgets(line, sizeof(line), f)) {
+        /* strip newline */
+        line[strcspn(line, "\r\n")] = '\0';
+        char *owner = strchr(line, '\t');
+        if (owner) *owner++ = '\0';
+        if (strlen(line) == 0 || strcmp(line, "Empty") == 0) set_seat(bus_no, idx + 1, NULL, NULL);
+        else set_seat(bus_no, idx + 1, line, owner);
+        idx++;
+    }
+    /* if file had fewer lines, fill rest with Empty */
+    while (idx < seat_count) {
+        set_seat(bus_no, idx + 1, NULL, NULL);
+        idx++;
+    }
+}
+
+/* Write status array back to file. Returns 1 on success, 0 if the file
+   could not be written (an error is printed and the old file is kept). */
+int write_status_from_array(int bus_no, char *status[], int count) {
+    if (!persist_changes) return 1;
+    char fname[64], part_fname[64];
+    snprintf(fname, sizeof(fname), "bus%d_status.txt", bus_no);
+    snprintf(part_fname, sizeof(part_fname), "bus%d_status.%ld.part", bus_no, (long)get_pid());
+
+    /* write the whole seat list to a temp file first, then swap it in,
+       so a crash never leaves a half-written status file behind. The temp
+       name carries our process id: two copies writing the same bus at once
+       each fill their own file, and the last rename wins whole. */
+    FILE *f = fopen(part_fname, "w");
+    if (!f) {
+        printf("Error writing status file for bus %d\n", bus_no);
+        return 0;
+    }
+    char **owner = seat_owner + fleet[bus_no-1].first_seat;
+    int ok = 1;
+    for (int i = 0; i < count; ++i) {
+        int n;
+        if (status[i] && owner[i]) n = fprintf(f, "%s\t%s\n", status[i], owner[i]);
+        else n = fprintf(f, "%s\n", status[i] ? status[i] : "Empty");
+        if (n < 0) ok = 0;
+        else stats.status_bytes_written += n;
+    }
+    stats.status_writes++;
+    /* force the data to disk before the rename publishes it, so a power
+       loss cannot leave an empty or stale file under the real name */
+    if (fflush(f) != 0 || sync_file(f) != 0) ok = 0;
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) {
+        printf("Error writing status file for bus %d\n", bus_no);
+        remove(part_fname);
+        return 0;
+    }
+    #ifdef _WIN32
+        /* rename() does not replace an existing file on Windows, so the old
+           file is removed first. Mark ours complete as .tmp before that, so
+           readers and startup recovery (find_status_tmp) can fall back to it */
+        char tmp_fname[64];
+        snprintf(tmp_fname, sizeof(tmp_fname), "bus%d_status.%ld.tmp", bus_no, (long)get_pid());
+        if (rename(part_fname, tmp_fname) != 0) {
+            printf("Error writing status file for bus %d\n", bus_no);
+            remove(part_fname);
+            return 0;
+        }
+        remove(fname);
+        if (rename(tmp_fname, fname) != 0) {
+            printf("Error writing status file for bus %d\n", bus_no);
+            return 0;
+        }
+    #else
+        if (rename(part_fname, fname) != 0) {
+            printf("Error writing status file for bus %d\n", bus_no);
+            remove(part_fname);
+            return 0;
+        }
+    #endif
+    remember_file_state(bus_no);
+    return 1;
+}
+
+/* Helper: get timestamp string (formatted at most once per second) */
+void get_timestamp(char *buf, size_t len) {
+    static time_t cached_time = (time_t)-1;
+    static char cached[32];
+    time_t t = time(NULL);
+    if (t != cached_time) {
+        struct tm *tm_info = localtime(&t);
+        strftime(cached, sizeof(cached), "%Y-%m-%d %H:%M:%S", tm_info);
+        cached_time = t;
+    }
+    strncpy(buf, cached, len-1);
+    buf[len-1] = '\0';
+}
+
+/* Append a log message into the session user's file with timestamp */
+void append_user_log(struct session *s, const char *fmt, ...) {
+    if (s->user[0] == '\0') return; /* no logged-in user */
+
+    /* the log file stays open for the rest of the session */
+    if (!s->log) {
+        char user_fname[128];
+        snprintf(user_fname, sizeof(user_fname), "%s.txt", s->user);
+        s->log = fopen(user_fname, "a");
+        if (!s->log) return;
+    }
+    FILE *uf = s->log;
+
+    /* timestamp */
+    char ts[64];
+    get_timestamp(ts, sizeof(ts));
+    long n = fprintf(uf, "%s - ", ts);
+
+    /* formatted message */
+    va_list args;
+    va_start(args, fmt);
+    n += vfprintf(uf, fmt, args);
+    va_end(args);
+
+    n += fprintf(uf, "\n");
+    fflush(uf); /* entry reaches the file now, without reopening it next time */
+    stats.log_writes++;
+    stats.log_bytes_written += n;
+}
+
+/* Close the session's log file (on logout and at exit) */
+void close_user_log(struct session *s) {
+    if (!s->log) return;
+    fclose(s->log);
+    s->log = NULL;
+}
+
+/* Sanitizes username: keep letters, digits, underscore, hyphen only.
+   returns 1 if good, 0 if invalid (empty after sanitize). */
+int sanitize_username(const char *in, char *out, size_t outlen) {
+    if (!in || !out || outlen == 0) return 0;
+    size_t j = 0;
+    for (size_t i = 0; in[i] != '\0' && j + 1 < outlen; ++i) {
+        char c = in[i];
+        if (isalnum((unsigned char)c) || c == '_' || c == '-') {
+            out[j++] = c;
+        } else {
+            /* skip other characters (space, slash, etc.) */
+        }
+    }
+    if (j == 0) {
+        out[0] = '\0';
+        return 0;
+    }
+    out[j] = '\0';
+    return 1;
+}
+
+/* Registration: creates an entry in users.txt and creates username.txt user file */
+void register_user() {
+    char username_raw[64], password[64], username[64];
+    printf("\n===== Register New User =====\n");
+    printf("Enter username (letters, digits, _ or - only): ");
+    if (!fgets(username_raw, sizeof(username_raw), stdin)) return;
+    username_raw[strcspn(username_raw, "\n")] = '\0';
+
+    if (!sanitize_username(username_raw, username, sizeof(username))) {
+        printf("Invalid username. Use letters/digits/_/- and avoid spaces.\n");
+        return;
+    }
+
+    printf("Enter password: ");
+    if (!fgets(password, sizeof(password), stdin)) return;
+    password[strcspn(password, "\n")] = '\0';
+
+    if (strlen(password) == 0) {
+        printf("Password cannot be empty.\n");
+        return;
+    }
+
+    /* check if user already exists */
+    if (find_user(username)) {
+        printf("Username already exists. Choose a different username.\n");
+        return;
+    }
+
+    /* append to users.txt */
+    FILE *f = fopen(USER_FILE, "a");
+    if (!f) {
+        printf("Error opening user database file.\n");
+        return;
+    }
+    fprintf(f, "%s %s\n", username, password);
+    fclose(f);
+    add_user_to_table(username, password);
+
+    /* create user's personal file and write header + registration log */
+    char user_fname[128];
+    snprintf(user_fname, sizeof(user_fname), "%s.txt", username);
+    FILE *uf = fopen(user_fname, "a");
+    if (!uf) {
+        printf("Error creating user file %s\n", user_fname);
+        return;
+    }
+    fprintf(uf, "== User: %s ==\n", username);
+    fprintf(uf, "Activity Log:\n");
+    fclose(uf);
+
+    /* write the registration entry through a short-lived session of the new
+       user; nobody is logged in by registering */
+    struct session reg = {{0}, NULL};
+    snprintf(reg.user, sizeof(reg.user), "%s", username);
+    append_user_log(&reg, "Registered");
+    close_user_log(&reg);
+
+    printf("Registration successful. You can now login.\n");
+}
+
+/* Login: check the user directory for username & password; on success start the session and log it */
+int login_user(struct session *s) {
+    char username_raw[64], password[64], username[64];
+    printf("\n===== Login =====\n");
+    printf("Username: ");
+    if (!fgets(username_raw, sizeof(username_raw), stdin)) return 0;
+    username_raw[strcspn(username_raw, "\n")] = '\0';
+
+    if (!sanitize_username(username_raw, username, sizeof(username))) {
+        printf("Invalid username format.\n");
+        return 0;
+    }
+
+    printf("Password: ");
+    if (!fgets(password, sizeof(password), stdin)) return 0;
+    password[strcspn(password, "\n")] = '\0';
+
+    if (authenticate_user(username, password)) {
+        close_user_log(s);
+        strncpy(s->user, username, sizeof(s->user)-1);
+        s->user[sizeof(s->user)-1] = '\0';
+        append_user_log(s, "Logged in");
+        printf("Login successful. Welcome, %s!\n", username);
+        return 1;
+    } else {
+        printf("Invalid credentials.\n");
+        return 0;
+    }
+}
+
+/* djb2 string hash */
+static unsigned long hash_username(const char *s) {
+    unsigned long h = 5381;
+    while (*s) h = h * 33 + (unsigned char)*s++;
+    return h;
+}
+
+/* Look up a user by sanitized username; returns NULL if not registered */
+struct user_entry *find_user(const char *username) {
+    if (user_table_size == 0) return NULL;
+    size_t mask = user_table_size - 1;
+    for (size_t i = hash_username(username) & mask; user_table[i].username[0] != '\0'; i = (i + 1) & mask) {
+        if (strcmp(user_table[i].username, username) == 0) return &user_table[i];
+    }
+    return NULL;
+}
+
+/* Double the table (or create it) and re-insert existing entries */
+static int grow_user_table() {
+    size_t new_size = user_table_size ? user_table_size * 2 : USER_TABLE_MIN_SIZE;
+    struct user_entry *new_table = calloc(new_size, sizeof(struct user_entry));
+    if (!new_table) return 0;
+    for (size_t i = 0; i < user_table_size; ++i) {
+        if (user_table[i].username[0] == '\0') continue;
+        size_t j = hash_username(user_table[i].username) & (new_size - 1);
+        while (new_table[j].username[0] != '\0') j = (j + 1) & (new_size - 1);
+        new_table[j] = user_table[i];
+    }
+    free(user_table);
+    user_table = new_table;
+    user_table_size = new_size;
+    return 1;
+}
+
+/* Insert a user into the directory. Returns 1 if added, 0 if it already exists or on error. */
+int add_user_to_table(const char *username, const char *password) {
+    if (find_user(username)) return 0;
+    /* keep load factor below 3/4 so probe chains stay short */
+    if ((user_count + 1) * 4 > user_table_size * 3 && !grow_user_table()) return 0;
+    size_t mask = user_table_size - 1;
+    size_t i = hash_username(username) & mask;
+    while (user_table[i].username[0] != '\0') i = (i + 1) & mask;
+    strncpy(user_table[i].username, username, CURRENT_USER_LEN-1);
+    user_table[i].username[CURRENT_USER_LEN-1] = '\0';
+    strncpy(user_table[i].password, password, PASSWORD_LEN-1);
+    user_table[i].password[PASSWORD_LEN-1] = '\0';
+    user_count++;
+    return 1;
+}
+
+/* Check a sanitized username and password against the directory; returns 1 on match */
+int authenticate_user(const char *username, const char *password) {
+    struct user_entry *e = find_user(username);
+    if (e && strcmp(e->password, password) == 0) {
+        stats.logins_ok++;
+        return 1;
+    }
+    stats.logins_failed++;
+    return 0;
+}
+
+/* Load users.txt into the directory (first entry wins for duplicate names).
+   A missing users.txt is created with the default admin account. */
+void load_users() {
+    FILE *f = fopen(USER_FILE, "r");
+    if (!f) {
+        f = fopen(USER_FILE, "w");
+        if (f) {
+            /* create a default admin account for convenience */
+            fprintf(f, "admin adminpass\n"); /* username admin, password adminpass */
+            fclose(f);
+        }
+        add_user_to_table("admin", "adminpass");
+        return;
+    }
+    char line[256], u[CURRENT_USER_LEN];
+    const char *pw;
+    while (fgets(line, sizeof(line), f)) {
+        if (split_user_line(line, u, &pw)) add_user_to_table(u, pw);
+    }
+    fclose(f);
+}
+
+/* Split a users.txt line, "<username> <password>", stripping the newline.
+   Exactly one space separates the two: the password is the rest of the
+   line as typed at registration, including any leading or inner spaces.
+   Returns 1 if the line has both parts. */
+int split_user_line(char *line, char user[CURRENT_USER_LEN], const char **password) {
+    int used = 0;
+    line[strcspn(line, "\r\n")] = '\0';
+    if (sscanf(line, "%63s%n", user, &used) != 1 || line[used] != ' ' || line[used+1] == '\0') return 0;
+    *password = line + used + 1;
+    return 1;
+}